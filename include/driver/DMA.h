@@ -16,6 +16,17 @@
 
 // -------------------------------------------------------------------------------------
 
+/**
+ * DMA controller support check, required:
+ *  - DMA_BASE - address od DMACTL0
+ *  - OFS_DMAIV - offset of IV register from base (DMAIV - DMA_BASE)
+ *  - DMA_VECTOR - number of DMA interrupt vector
+ *  - OFS_DMACTL4 - offset of DMA config register (x2xx and x4xx are not supported)
+ */
+#if defined(DMA_BASE) && defined(OFS_DMAIV) && defined(DMA_VECTOR) && defined(OFS_DMACTL4)
+#define __DMA_CONTROLLER_SUPPORT__
+#endif
+
 /**
  * Total DMA channel count
  */
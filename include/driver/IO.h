@@ -314,6 +314,11 @@
 // get (possibly) registered port by port number
 #define IO_port_driver(_port_no) registered_drivers[(_port_no) - 1]
 
+// getter, setter - address of counter register (e.g. TA0R) sampled on port interrupt entry, zero ~ disabled
+#define IO_port_timestamp_source(_driver) _IO_port_driver_(_driver)->_timestamp_register
+// counter value sampled on entry of port interrupt being serviced
+#define IO_port_timestamp(_driver) _IO_port_driver_(_driver)->timestamp
+
 // reg IN|OUT|DIR|REN|DS|SEL0|SEL1|SELC|IES|IE|IFG
 #define IO_driver_reg(_driver, _reg) _IO_driver_reg_offset_(_driver, OFS_Px ## _reg)
 #define IO_driver_reg_set(_driver, _reg, _mask) _IO_driver_reg_offset_(_driver, OFS_Px ## _reg) |= ((uint8_t) (_mask))
@@ -369,6 +374,19 @@ typedef void (*port_init_handler_t)(IO_port_driver_t *_this);
  */
 extern IO_port_driver_t *registered_drivers[];
 
+/**
+ * Pins that caused last wakeup from LPMx.5, set by IO_wakeup_reinit() before any port interrupt is serviced
+ */
+typedef struct IO_wakeup_source {
+    // port number (1 - 12), zero if no enabled interrupt was pending
+    uint8_t port_no;
+    // pending enabled interrupts of port
+    uint8_t pin_mask;
+
+} IO_wakeup_source_t;
+
+extern IO_wakeup_source_t IO_wakeup_source;
+
 /**
  * Physical IO port control
  */
@@ -400,10 +418,14 @@ struct IO_port_driver {
     IO_pin_handle_t *_pin7_handle;
     // shared vector slot
     Vector_slot_t *_slot;
+    // counter register sampled on interrupt entry, single read is consistent only when timer clock is synchronous to MCLK
+    uint16_t _timestamp_register;
 
     // -------- public --------
     // register handle for given pin mask
     uint8_t (*pin_handle_register)(IO_port_driver_t *_this, IO_pin_handle_t *handle, uint8_t pin_mask);
+    // counter value sampled on entry of interrupt being serviced, read-only
+    uint16_t timestamp;
 
 };
 
@@ -425,7 +447,8 @@ struct IO_pin_handle {
     // -------- state --------
     // vector interrupt service handler
     vector_slot_handler_t _handler;
-    // vector interrupt service handler argument 1 (argument 2 is the interrupt source pin)
+    // vector interrupt service handler argument 1 (argument 2 is the interrupt source pin, pin mask
+    // of all pending pins of handle when __IO_PORT_COALESCED_DISPATCH__ is defined)
     void *_handler_arg;
 
 };
@@ -456,11 +479,16 @@ void IO_port_driver_register(IO_port_driver_t *driver, uint8_t port_no, uint16_t
  *   2. Clear the LOCKLPM5 bit in the PM5CTL0 register.
  *   3. Enable port interrupts as necessary. -> enable all interrupts that were enabled before device entered low-power mode
  *   4. After enabling the port interrupts the wake-up interrupt will be serviced as a normal interrupt.
+ *  - if IO_low_power_mode_prepare() was called, then port registers, interrupt enable bits and vector slots are restored
+ * from snapshot taken by it (port_init is not executed), otherwise port_init of each driver is executed
+ *  - first port with pending enabled interrupt is stored in IO_wakeup_source
  */
 void IO_wakeup_reinit(void);
 
 /**
  * Prepare all registered IO drivers and handles for low power mode
+ *  - register images (OUT, DIR, REN, SEL, IES, IE) of ports with port_init set are stored in persistent table
+ * for IO_wakeup_reinit(), taken before pin functions are reset
  *  - all pins are set to general-purpose IO except those that are in driver->low_power_mode_pin_reset_filter
  *  - interrupts should be disabled already before calling this function
  */
@@ -0,0 +1,137 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ *  Input debounce - edge interrupt masked on first edge, pins sampled periodically on shared timer compare handle
+ *
+ *  Copyright (c) 2018-2019 Mutant Industries ltd.
+ */
+
+#ifndef _DRIVER_IO_DEBOUNCE_H_
+#define _DRIVER_IO_DEBOUNCE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <driver/disposable.h>
+#include <driver/IO.h>
+#include <driver/timer.h>
+
+// -------------------------------------------------------------------------------------
+
+#define _IO_debounce_(_debounce)                ((IO_debounce_t *) (_debounce))
+#define _IO_debounce_input_(_input)             ((IO_debounce_input_t *) (_input))
+#define IO_debounce_event_handler(_handler)     ((IO_debounce_event_handler_t) (_handler))
+
+/**
+ * Debounce public API access
+ */
+#define IO_debounce_is_active(_debounce)                                            \
+        _IO_debounce_(_debounce)->active
+// debounced level of input pins
+#define IO_debounce_input_state(_input)                                             \
+        _IO_debounce_input_(_input)->state
+
+// getter, setter
+#define IO_debounce_input_on_change(_input) _IO_debounce_input_(_input)->_on_change
+#define IO_debounce_input_owner(_input) _IO_debounce_input_(_input)->_owner
+
+/**
+ * Debounce public API return codes
+ */
+#define IO_DEBOUNCE_OK                          IO_OK
+#define IO_DEBOUNCE_UNSUPPORTED_OPERATION       IO_UNSUPPORTED_OPERATION
+#define IO_DEBOUNCE_VECTOR_SLOT_UNAVAILABLE     (0x24)
+
+/**
+ * Count of consecutive samples of new level required to accept transition (vertical counter depth)
+ */
+#define IO_DEBOUNCE_SAMPLE_CNT                  (4)
+
+// -------------------------------------------------------------------------------------
+
+typedef struct IO_debounce IO_debounce_t;
+typedef struct IO_debounce_input IO_debounce_input_t;
+
+/**
+ * Debounced transition event handler
+ *  - owner - input owner, input itself by default
+ *  - changed - pin mask of pins that changed level
+ *  - state - debounced level of all input pins
+ */
+typedef void (*IO_debounce_event_handler_t)(void *owner, uint8_t changed, uint8_t state);
+
+/**
+ * Debounce engine - one periodic compare handle shared by any count of inputs on any ports
+ *  - sampling runs only while at least one input is unstable, the timer handle is stopped otherwise
+ *  - interrupt load is one edge interrupt per transition plus IO_DEBOUNCE_SAMPLE_CNT (up to twice as much
+ * while bouncing) sample interrupts, regardless of count of bounces
+ */
+struct IO_debounce {
+    // enable dispose(IO_debounce_t *)
+    Disposable_t _disposable;
+    // sampling compare handle of timer in MC__CONTINUOUS mode
+    Timer_channel_handle_t *_handle;
+    // distance of samples [ticks]
+    uint16_t _sample_period;
+
+    // -------- state --------
+    // registered inputs
+    IO_debounce_input_t *_inputs;
+    // count of inputs being sampled
+    uint8_t _sampling_cnt;
+
+    // -------- public --------
+    // sampling running, read-only
+    volatile bool active;
+
+};
+
+/**
+ * Group of pins of one pin handle debounced together
+ *  - 2-bit vertical counter per pin, transition is accepted after IO_DEBOUNCE_SAMPLE_CNT consecutive samples of new level
+ *  - on first edge the pin handle interrupt is masked, then all pins of handle are sampled until stable
+ * for IO_DEBOUNCE_SAMPLE_CNT samples, then interrupt edge select (PxIES) is set opposite to debounced level
+ * and interrupt is enabled again
+ *  - pins must be configured as inputs by application (DIR, REN, OUT)
+ */
+struct IO_debounce_input {
+    // enable dispose(IO_debounce_input_t *)
+    Disposable_t _disposable;
+    // debounce engine
+    IO_debounce_t *_engine;
+    // debounced pins
+    IO_pin_handle_t *_handle;
+    // next registered input
+    IO_debounce_input_t *_next;
+
+    // -------- state --------
+    // vertical counter
+    uint8_t _counter_0;
+    uint8_t _counter_1;
+    // consecutive samples without change
+    uint8_t _stable_cnt;
+    // input is being sampled
+    bool _sampling;
+    // debounced transition handler
+    IO_debounce_event_handler_t _on_change;
+    // event handler first argument, input itself by default
+    void *_owner;
+
+    // -------- public --------
+    // debounced level of pins, read-only
+    volatile uint8_t state;
+
+};
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Initialize debounce engine on registered handle (not OVERFLOW)
+ */
+uint8_t IO_debounce_register(IO_debounce_t *debounce, Timer_channel_handle_t *handle, uint16_t sample_period);
+
+/**
+ * Initialize debounced input on registered pin handle, current level is taken as debounced, edge interrupt is enabled
+ */
+uint8_t IO_debounce_input_register(IO_debounce_input_t *input, IO_debounce_t *debounce, IO_pin_handle_t *handle);
+
+
+#endif /* _DRIVER_IO_DEBOUNCE_H_ */
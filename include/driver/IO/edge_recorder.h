@@ -0,0 +1,110 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ *  Edge recorder - timestamped pin edges in ring buffer, both-edge detection emulated by PxIES flip
+ *
+ *  Copyright (c) 2018-2019 Mutant Industries ltd.
+ */
+
+#ifndef _DRIVER_IO_EDGE_RECORDER_H_
+#define _DRIVER_IO_EDGE_RECORDER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <driver/disposable.h>
+#include <driver/IO.h>
+
+// -------------------------------------------------------------------------------------
+
+#define _IO_edge_recorder_(_recorder)           ((IO_edge_recorder_t *) (_recorder))
+
+/**
+ * Edge recorder public API access
+ */
+#define IO_edge_recorder_start(_recorder)                                           \
+        (_IO_edge_recorder_(_recorder)->start(_IO_edge_recorder_(_recorder)))
+#define IO_edge_recorder_stop(_recorder)                                            \
+        (_IO_edge_recorder_(_recorder)->stop(_IO_edge_recorder_(_recorder)))
+#define IO_edge_recorder_read(_recorder, _target)                                   \
+        (_IO_edge_recorder_(_recorder)->read(_IO_edge_recorder_(_recorder), (IO_edge_record_t *) (_target)))
+#define IO_edge_recorder_available(_recorder)                                       \
+        (_IO_edge_recorder_(_recorder)->available(_IO_edge_recorder_(_recorder)))
+#define IO_edge_recorder_is_active(_recorder)                                       \
+        _IO_edge_recorder_(_recorder)->active
+
+/**
+ * Edge recorder public API return codes
+ */
+#define IO_EDGE_RECORDER_OK                         IO_OK
+#define IO_EDGE_RECORDER_UNSUPPORTED_OPERATION      IO_UNSUPPORTED_OPERATION
+#define IO_EDGE_RECORDER_VECTOR_SLOT_UNAVAILABLE    (0x24)
+#define IO_EDGE_RECORDER_ACTIVE                     (0x25)
+#define IO_EDGE_RECORDER_EMPTY                      (0x28)
+
+// -------------------------------------------------------------------------------------
+
+typedef struct IO_edge_recorder IO_edge_recorder_t;
+
+/**
+ * Single recorded edge
+ */
+typedef struct IO_edge_record {
+    // counter value sampled on port interrupt entry {@see IO_port_timestamp_source()}
+    uint16_t timestamp;
+    // pin (PIN_0 - PIN_7)
+    uint8_t pin;
+    // pin level after edge (1 ~ rising edge)
+    uint8_t level;
+
+} IO_edge_record_t;
+
+/**
+ * Edge recorder on pin handle
+ *  - timestamp source must be set on port driver, otherwise all timestamps are zero
+ *  - both-edge mode - after each edge PxIES is set opposite to current level; when the level read from PxIN differs
+ * from level expected after the serviced edge, then another edge occurred before PxIES was flipped and it is recorded
+ * with the same timestamp, so that edge count and levels are always consistent
+ *  - records are pushed from interrupt, when buffer is full new records are dropped and counted in overrun_cnt
+ */
+struct IO_edge_recorder {
+    // enable dispose(IO_edge_recorder_t *)
+    Disposable_t _disposable;
+    // recorded pins
+    IO_pin_handle_t *_handle;
+    // ring buffer
+    IO_edge_record_t *_buffer;
+    uint16_t _length;
+    // record both edges
+    bool _both_edges;
+
+    // -------- state --------
+    // ring buffer indexes
+    volatile uint16_t _head;
+    volatile uint16_t _tail;
+
+    // -------- public --------
+    // clear buffer, set edge select (both-edge mode), enable pin interrupts
+    uint8_t (*start)(IO_edge_recorder_t *_this);
+    // disable pin interrupts, recorded edges can still be read
+    uint8_t (*stop)(IO_edge_recorder_t *_this);
+    // read oldest record
+    uint8_t (*read)(IO_edge_recorder_t *_this, IO_edge_record_t *target);
+    // count of records available
+    uint16_t (*available)(IO_edge_recorder_t *_this);
+    // count of dropped records, read-only
+    uint16_t overrun_cnt;
+    // running state
+    bool active;
+
+};
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Initialize edge recorder on registered pin handle
+ *  - pins must be configured as inputs by application, in single-edge mode PxIES is used as set by application
+ */
+uint8_t IO_edge_recorder_register(IO_edge_recorder_t *recorder, IO_pin_handle_t *handle, IO_edge_record_t *buffer, uint16_t length,
+        bool both_edges);
+
+
+#endif /* _DRIVER_IO_EDGE_RECORDER_H_ */
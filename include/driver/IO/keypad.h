@@ -0,0 +1,145 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ *  Keypad matrix scanner - column edge interrupt while idle, row-by-row scan on timer compare handle while any key is down
+ *
+ *  Copyright (c) 2018-2019 Mutant Industries ltd.
+ */
+
+#ifndef _DRIVER_IO_KEYPAD_H_
+#define _DRIVER_IO_KEYPAD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <driver/disposable.h>
+#include <driver/IO.h>
+#include <driver/timer.h>
+
+// -------------------------------------------------------------------------------------
+
+#define _IO_keypad_(_keypad)                    ((IO_keypad_t *) (_keypad))
+#define IO_keypad_event_handler(_handler)       ((IO_keypad_event_handler_t) (_handler))
+
+/**
+ * Keypad public API access
+ */
+#define IO_keypad_start(_keypad)                                                    \
+        (_IO_keypad_(_keypad)->start(_IO_keypad_(_keypad)))
+#define IO_keypad_stop(_keypad)                                                     \
+        (_IO_keypad_(_keypad)->stop(_IO_keypad_(_keypad)))
+// debounced column pin mask of pressed keys in row given by row pin number (0 - 7)
+#define IO_keypad_row_state(_keypad, _row_pin_no)                                   \
+        _IO_keypad_(_keypad)->state[_row_pin_no]
+#define IO_keypad_key_cnt(_keypad)                                                  \
+        _IO_keypad_(_keypad)->key_cnt
+#define IO_keypad_is_ghosting(_keypad)                                              \
+        _IO_keypad_(_keypad)->ghosting
+#define IO_keypad_is_scanning(_keypad)                                              \
+        _IO_keypad_(_keypad)->scanning
+#define IO_keypad_is_active(_keypad)                                                \
+        _IO_keypad_(_keypad)->active
+
+// getter, setter
+#define IO_keypad_on_key(_keypad) _IO_keypad_(_keypad)->_on_key
+#define IO_keypad_owner(_keypad) _IO_keypad_(_keypad)->_owner
+
+/**
+ * Key code - row pin number in bits 5-3, column pin number in bits 2-0
+ */
+#define IO_keypad_key(_row_pin_no, _column_pin_no)  ((uint8_t) (((_row_pin_no) << 3) | (_column_pin_no)))
+#define IO_keypad_key_row(_key)                     ((uint8_t) ((_key) >> 3))
+#define IO_keypad_key_column(_key)                  ((uint8_t) ((_key) & 0x07))
+
+/**
+ * Keypad public API return codes
+ */
+#define IO_KEYPAD_OK                            IO_OK
+#define IO_KEYPAD_UNSUPPORTED_OPERATION         IO_UNSUPPORTED_OPERATION
+#define IO_KEYPAD_VECTOR_SLOT_UNAVAILABLE       (0x24)
+#define IO_KEYPAD_ACTIVE                        (0x25)
+
+/**
+ * Count of consecutive equal scans required to accept matrix state
+ */
+#define IO_KEYPAD_DEBOUNCE_CNT                  (3)
+
+// -------------------------------------------------------------------------------------
+
+typedef struct IO_keypad IO_keypad_t;
+
+/**
+ * Key event handler
+ *  - owner - keypad owner, keypad itself by default
+ *  - key - key code {@see IO_keypad_key()}
+ *  - pressed - true on press, false on release
+ */
+typedef void (*IO_keypad_event_handler_t)(void *owner, uint8_t key, bool pressed);
+
+/**
+ * Keypad matrix up to 8x8, rows on pins of one handle, columns on pins of another handle (any ports)
+ *  - idle - all rows driven low, columns pulled up with falling edge interrupt enabled, timer handle stopped
+ *  - on column edge the column interrupt is masked and rows are scanned one per compare period - compare interrupt
+ * reads columns of the row selected in previous one (so that the period is also the settle time) and selects next row,
+ * non-selected rows are high impedance
+ *  - matrix state is accepted after IO_KEYPAD_DEBOUNCE_CNT consecutive equal scans, key events are reported for
+ * each changed key, any count of keys is reported unless ambiguous
+ *  - without diodes two rows sharing two or more pressed columns form a rectangle, the fourth key of which
+ * cannot be told from ghost - state is held and ghosting flag is set until resolved
+ *  - when all keys are released the keypad returns to idle
+ */
+struct IO_keypad {
+    // enable dispose(IO_keypad_t *)
+    Disposable_t _disposable;
+    // row pins
+    IO_pin_handle_t *_row_handle;
+    // column pins
+    IO_pin_handle_t *_column_handle;
+    // scan compare handle of timer in MC__CONTINUOUS mode
+    Timer_channel_handle_t *_handle;
+    // row select to column read [ticks]
+    uint16_t _row_period;
+    // diode in series with each key, ghosting not possible
+    bool _diodes;
+
+    // -------- state --------
+    // pin number of selected row
+    uint8_t _row;
+    // raw column pin mask per row pin number, last scan
+    uint8_t _raw[8];
+    // raw state changed during current scan
+    bool _scan_changed;
+    // consecutive equal scans
+    uint8_t _stable_cnt;
+    // key event handler
+    IO_keypad_event_handler_t _on_key;
+    // event handler first argument, keypad itself by default
+    void *_owner;
+
+    // -------- public --------
+    // configure pins, wait for key press
+    uint8_t (*start)(IO_keypad_t *_this);
+    // stop scan, disable column interrupt
+    uint8_t (*stop)(IO_keypad_t *_this);
+    // debounced column pin mask of pressed keys per row pin number, read-only
+    volatile uint8_t state[8];
+    // count of pressed keys, read-only
+    volatile uint8_t key_cnt;
+    // pressed keys ambiguous, state held, read-only
+    volatile bool ghosting;
+    // scan running, read-only
+    volatile bool scanning;
+    // running state
+    bool active;
+
+};
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Initialize keypad on registered pin handles and registered compare handle (not OVERFLOW)
+ *  - row pins are set to output low, column pins to input with pull-up on start
+ */
+uint8_t IO_keypad_register(IO_keypad_t *keypad, IO_pin_handle_t *row_handle, IO_pin_handle_t *column_handle,
+        Timer_channel_handle_t *handle, uint16_t row_period, bool diodes);
+
+
+#endif /* _DRIVER_IO_KEYPAD_H_ */
@@ -0,0 +1,182 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ *  Logic capture - port inputs sampled by DMA at timer rate into circular buffer, pre / post trigger, run-length export
+ *
+ *  Copyright (c) 2018-2019 Mutant Industries ltd.
+ */
+
+#ifndef _DRIVER_IO_LOGIC_CAPTURE_H_
+#define _DRIVER_IO_LOGIC_CAPTURE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <driver/DMA.h>
+#include <driver/disposable.h>
+#include <driver/IO.h>
+#include <driver/timer.h>
+#include <driver/eUSCI/UART.h>
+
+// -------------------------------------------------------------------------------------
+
+#define _IO_logic_capture_(_capture)                ((IO_logic_capture_t *) (_capture))
+#define IO_logic_capture_event_handler(_handler)    ((IO_logic_capture_event_handler_t) (_handler))
+
+/**
+ * Logic capture public API access
+ */
+#define IO_logic_capture_start(_capture)                                            \
+        (_IO_logic_capture_(_capture)->start(_IO_logic_capture_(_capture)))
+#define IO_logic_capture_stop(_capture)                                             \
+        (_IO_logic_capture_(_capture)->stop(_IO_logic_capture_(_capture)))
+#define IO_logic_capture_trigger(_capture)                                          \
+        (_IO_logic_capture_(_capture)->trigger(_IO_logic_capture_(_capture)))
+// count of valid samples after capture complete, read-only
+#define IO_logic_capture_sample_cnt(_capture)                                       \
+        _IO_logic_capture_(_capture)->sample_cnt
+// chronological index of first sample taken after trigger, read-only
+#define IO_logic_capture_trigger_sample(_capture)                                   \
+        _IO_logic_capture_(_capture)->trigger_sample
+#define IO_logic_capture_is_complete(_capture)                                      \
+        _IO_logic_capture_(_capture)->complete
+#define IO_logic_capture_is_active(_capture)                                        \
+        _IO_logic_capture_(_capture)->active
+
+// getter, setter
+#define IO_logic_capture_on_complete(_capture) _IO_logic_capture_(_capture)->_on_complete
+#define IO_logic_capture_owner(_capture) _IO_logic_capture_(_capture)->_owner
+#define IO_logic_capture_event_arg(_capture) _IO_logic_capture_(_capture)->_event_arg
+
+/**
+ * Logic capture public API return codes
+ */
+#define IO_LOGIC_CAPTURE_OK                         IO_OK
+#define IO_LOGIC_CAPTURE_UNSUPPORTED_OPERATION      IO_UNSUPPORTED_OPERATION
+#define IO_LOGIC_CAPTURE_VECTOR_SLOT_UNAVAILABLE    (0x24)
+#define IO_LOGIC_CAPTURE_ACTIVE                     (0x25)
+#define IO_LOGIC_CAPTURE_NOT_ACTIVE                 (0x26)
+#define IO_LOGIC_CAPTURE_INVALID_CONFIG             (0x27)
+#define IO_LOGIC_CAPTURE_EMPTY                      (0x28)
+
+/**
+ * Run-length export - header followed by records
+ *  - header - IO_LOGIC_CAPTURE_EXPORT_MAGIC (2 bytes), sample width in bytes (1 byte), sample_cnt, trigger_sample,
+ * sample_period (2 bytes each, little endian)
+ *  - record - sample value (sample width, little endian), count of repetitions - 1 (1 byte), runs longer than 256
+ * samples are split
+ */
+#define IO_LOGIC_CAPTURE_EXPORT_MAGIC_0             ('L')
+#define IO_LOGIC_CAPTURE_EXPORT_MAGIC_1             ('C')
+
+// -------------------------------------------------------------------------------------
+
+typedef struct IO_logic_capture IO_logic_capture_t;
+typedef void (*IO_logic_capture_event_handler_t)(void *owner, void *event_arg);
+
+/**
+ * Logic capture config
+ */
+typedef struct IO_logic_capture_config {
+    // sampled port, odd port number (PORT_1 ~ PORT_A...) when word access is used
+    IO_port_driver_t *port;
+    // 16 signals of word port (PORT_A - PORT_F)
+    bool word_access;
+    // MAIN handle of sampling timer, timer must be registered in MC__UP mode
+    Timer_channel_handle_t *sample_handle;
+    // sample period [ticks]
+    uint16_t sample_period;
+    // DMA channel that transfers PxIN to buffer
+    DMA_channel_handle_t *DMA_channel;
+    // DMA trigger corresponding to sample handle (DMA0TSEL__TA0CCR0...)
+    uint16_t DMA_trigger;
+    // sample buffer (uint8_t[] or uint16_t[] depending on word_access), RAM or FRAM
+    void *buffer;
+    // buffer length [samples]
+    uint16_t length;
+    // count of samples taken after trigger, less than length, the rest of buffer holds samples preceding trigger
+    uint16_t post_trigger_cnt;
+    // optional trigger pins, edge select (PxIES) set by application
+    IO_pin_handle_t *trigger_handle;
+    // trigger condition - on trigger pin edge, (PxIN & pattern_mask) == pattern_value of sampled port, zero mask ~ any
+    uint16_t pattern_mask;
+    uint16_t pattern_value;
+
+} IO_logic_capture_config_t;
+
+/**
+ * Logic analyzer on port inputs
+ *  - sample timer in MC__UP mode with CCR0 = sample_period - 1, on each CCR0 event DMA copies PxIN (PAIN...)
+ * to circular buffer (repeated single transfer), no CPU load per sample, one DMA interrupt per buffer wrap
+ *  - trigger (pin edge matching pattern or software) switches DMA to single transfer of post_trigger_cnt samples
+ * from current position, the sample timer is held for the few cycles of reprogramming, so no sample is lost
+ * (the sample interval at trigger is stretched), capture completes on DMA transfer complete interrupt
+ *  - pattern is evaluated in trigger interrupt, so the state of port at that time is matched, not the state at edge
+ *  - maximum sample rate is limited by DMA transfer time (2 MCLK cycles per transfer + CPU / other channel contention)
+ */
+struct IO_logic_capture {
+    // enable dispose(IO_logic_capture_t *)
+    Disposable_t _disposable;
+    // capture config
+    IO_logic_capture_config_t _config;
+    // sampled port PxIN register
+    uint16_t _data_register;
+
+    // -------- state --------
+    // buffer index of first post-trigger sample
+    uint16_t _trigger_index;
+    // post-trigger samples left after DMA reaches end of buffer
+    uint16_t _post_remaining;
+    // buffer index following the last post-trigger sample
+    uint16_t _end_index;
+    // buffer index of oldest valid sample
+    uint16_t _oldest_index;
+    // timer mode control bits while sample clock held
+    uint16_t _sample_clock_mode;
+    // buffer wrapped at least once
+    bool _filled;
+    // trigger occurred
+    bool _triggered;
+    // capture complete event handler
+    IO_logic_capture_event_handler_t _on_complete;
+    // event handler first argument, capture itself by default
+    void *_owner;
+    // event handler second argument
+    void *_event_arg;
+
+    // -------- public --------
+    // start pre-trigger sampling, enable trigger interrupt
+    uint8_t (*start)(IO_logic_capture_t *_this);
+    // abort capture, no samples valid
+    uint8_t (*stop)(IO_logic_capture_t *_this);
+    // software trigger
+    uint8_t (*trigger)(IO_logic_capture_t *_this);
+    // count of valid samples, read-only
+    uint16_t sample_cnt;
+    // chronological index of first post-trigger sample, read-only
+    uint16_t trigger_sample;
+    // capture complete, read-only
+    volatile bool complete;
+    // sampling running, read-only
+    volatile bool active;
+
+};
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Initialize logic capture, port pin functions must be set by application
+ */
+uint8_t IO_logic_capture_register(IO_logic_capture_t *capture, IO_logic_capture_config_t *config);
+
+/**
+ * Get sample by chronological index (0 ~ oldest) of complete capture
+ */
+uint16_t IO_logic_capture_sample(IO_logic_capture_t *capture, uint16_t index);
+
+/**
+ * Blocking run-length export of complete capture over configured and enabled UART {@see IO_LOGIC_CAPTURE_EXPORT_MAGIC_0}
+ *  - UART transmit interrupt must be disabled, transmit buffer empty flag is polled
+ */
+uint8_t IO_logic_capture_export(IO_logic_capture_t *capture, UART_driver_t *uart);
+
+
+#endif /* _DRIVER_IO_LOGIC_CAPTURE_H_ */
@@ -0,0 +1,162 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ *  Parallel bus master - 8080 / 6800 style bus on 8-bit port or 16-bit word port, blocking or DMA-fed transfers
+ *
+ *  Copyright (c) 2018-2019 Mutant Industries ltd.
+ */
+
+#ifndef _DRIVER_IO_PARALLEL_BUS_H_
+#define _DRIVER_IO_PARALLEL_BUS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <driver/DMA.h>
+#include <driver/disposable.h>
+#include <driver/IO.h>
+#include <driver/timer.h>
+
+// -------------------------------------------------------------------------------------
+
+#define _IO_parallel_bus_(_bus)                 ((IO_parallel_bus_t *) (_bus))
+#define IO_parallel_bus_event_handler(_handler) ((IO_parallel_bus_event_handler_t) (_handler))
+
+/**
+ * Parallel bus public API access
+ */
+#define IO_parallel_bus_select(_bus)                                                \
+        (_IO_parallel_bus_(_bus)->select(_IO_parallel_bus_(_bus), true))
+#define IO_parallel_bus_deselect(_bus)                                              \
+        (_IO_parallel_bus_(_bus)->select(_IO_parallel_bus_(_bus), false))
+#define IO_parallel_bus_write(_bus, _command, _buffer, _length)                     \
+        (_IO_parallel_bus_(_bus)->write(_IO_parallel_bus_(_bus), _command, (const void *) (_buffer), _length))
+#define IO_parallel_bus_read(_bus, _command, _buffer, _length)                      \
+        (_IO_parallel_bus_(_bus)->read(_IO_parallel_bus_(_bus), _command, (void *) (_buffer), _length))
+#define IO_parallel_bus_write_DMA(_bus, _command, _buffer, _length)                 \
+        (_IO_parallel_bus_(_bus)->write_DMA(_IO_parallel_bus_(_bus), _command, (const void *) (_buffer), _length))
+#define IO_parallel_bus_is_busy(_bus)                                               \
+        _IO_parallel_bus_(_bus)->busy
+
+// getter, setter
+#define IO_parallel_bus_on_transfer_complete(_bus) _IO_parallel_bus_(_bus)->_on_transfer_complete
+#define IO_parallel_bus_owner(_bus) _IO_parallel_bus_(_bus)->_owner
+#define IO_parallel_bus_event_arg(_bus) _IO_parallel_bus_(_bus)->_event_arg
+
+/**
+ * Parallel bus public API return codes
+ */
+#define IO_PARALLEL_BUS_OK                          IO_OK
+#define IO_PARALLEL_BUS_UNSUPPORTED_OPERATION       IO_UNSUPPORTED_OPERATION
+#define IO_PARALLEL_BUS_VECTOR_SLOT_UNAVAILABLE     (0x24)
+#define IO_PARALLEL_BUS_BUSY                        (0x25)
+#define IO_PARALLEL_BUS_INVALID_CONFIG              (0x27)
+
+// -------------------------------------------------------------------------------------
+
+typedef struct IO_parallel_bus IO_parallel_bus_t;
+typedef void (*IO_parallel_bus_event_handler_t)(void *owner, void *event_arg);
+
+typedef enum {
+    /**
+     * Intel 8080 - active low write (WR#) and read (RD#) strobes, data latched on rising edge of WR#
+     */
+    PARALLEL_BUS_8080 = 1,
+    /**
+     * Motorola 6800 - active high enable strobe (E) for both directions, read / write select level (R/W#),
+     * data latched on falling edge of E
+     */
+    PARALLEL_BUS_6800 = 2
+
+} IO_parallel_bus_mode;
+
+/**
+ * Parallel bus config
+ */
+typedef struct IO_parallel_bus_config {
+    IO_parallel_bus_mode mode;
+    // data port, odd port number (PORT_1 ~ PORT_A...) when word access is used
+    IO_port_driver_t *data_port;
+    // 16-bit data bus on word port (PORT_A - PORT_F)
+    bool word_access;
+    // write strobe (8080 WR#, 6800 E) - compare handle the output pin of which is connected to bus
+    Timer_channel_handle_t *strobe_handle;
+    // optional read strobe (8080 RD#) / direction (6800 R/W#) pin, NULL for write-only bus
+    IO_pin_handle_t *read_handle;
+    // optional chip select pin (active low)
+    IO_pin_handle_t *select_handle;
+    // optional command / data pin (D/C#, RS), low ~ command
+    IO_pin_handle_t *command_handle;
+    // ---- DMA mode ----
+    // MAIN handle of strobe timer, strobe timer must be registered in MC__UP mode
+    Timer_channel_handle_t *period_handle;
+    // one bus cycle in DMA mode [ticks]
+    uint16_t strobe_period;
+    // active strobe level within bus cycle [ticks], data is written by DMA at the beginning of bus cycle
+    uint16_t strobe_width;
+    // DMA channel that transfers data to PxOUT
+    DMA_channel_handle_t *DMA_channel;
+    // DMA trigger corresponding to period handle (DMA0TSEL__TA0CCR0...)
+    uint16_t DMA_trigger;
+    // DMA channel that ends strobe generation after the last transfer
+    DMA_channel_handle_t *DMA_stop_channel;
+    // DMA trigger corresponding to DMA channel transfer complete (DMAxIFG of previous channel, see datasheet)
+    uint16_t DMA_stop_trigger;
+
+} IO_parallel_bus_config_t;
+
+/**
+ * Parallel bus master
+ *  - blocking transfers - data written directly to PxOUT, strobe generated by toggling OUT bit of strobe handle
+ * (OUTMOD_0), so timing is given by CPU clock, one word in ~10 cycles
+ *  - DMA mode - timer in MC__UP mode with CCR0 = strobe_period - 1, on each CCR0 event DMA writes one word
+ * to PxOUT and strobe handle output switches active (OUTMOD_3 / OUTMOD_7), on compare event of strobe handle
+ * (strobe_width) switches inactive and data is latched; no CPU load per word
+ *  - last strobe - second DMA channel triggered by completion of data channel switches strobe handle output
+ * to OUTMOD_1 / OUTMOD_5 (inactive on next compare event), so no extra strobe is generated regardless
+ * of interrupt latency, transfer complete interrupt of second channel waits until the last strobe ends (compare
+ * event of strobe handle) and stops the timer
+ *  - chip select and command / data levels are not changed by transfers, port pin functions must be set by application
+ */
+struct IO_parallel_bus {
+    // enable dispose(IO_parallel_bus_t *)
+    Disposable_t _disposable;
+    // bus config
+    IO_parallel_bus_config_t _config;
+    // data port PxIN register
+    uint16_t _data_register;
+    // inactive strobe output bit (8080 ~ OUT, 6800 ~ 0)
+    uint16_t _strobe_idle;
+
+    // -------- state --------
+    // strobe handle control register value written by stop DMA channel
+    uint16_t _strobe_stop;
+    // transfer complete handler
+    IO_parallel_bus_event_handler_t _on_transfer_complete;
+    // event handler first argument, bus itself by default
+    void *_owner;
+    // event handler second argument
+    void *_event_arg;
+
+    // -------- public --------
+    // set chip select level
+    uint8_t (*select)(IO_parallel_bus_t *_this, bool selected);
+    // blocking write of length words (bytes on 8-bit bus)
+    uint8_t (*write)(IO_parallel_bus_t *_this, bool command, const void *buffer, uint16_t length);
+    // blocking read of length words (bytes on 8-bit bus)
+    uint8_t (*read)(IO_parallel_bus_t *_this, bool command, void *buffer, uint16_t length);
+    // start DMA write of length words, on_transfer_complete handler is executed when the last strobe finished
+    uint8_t (*write_DMA)(IO_parallel_bus_t *_this, bool command, const void *buffer, uint16_t length);
+    // DMA transfer in progress, read-only
+    volatile bool busy;
+
+};
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Initialize parallel bus, data port is switched to output, strobes and chip select are set inactive
+ *  - all handles must be registered already, DMA members of config are optional (write_DMA is not supported if not set)
+ */
+uint8_t IO_parallel_bus_register(IO_parallel_bus_t *bus, IO_parallel_bus_config_t *config);
+
+
+#endif /* _DRIVER_IO_PARALLEL_BUS_H_ */
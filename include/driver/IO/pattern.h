@@ -0,0 +1,159 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ *  Pattern generator - precomputed port output patterns written to PxOUT by DMA at timer rate, fixed or variable timing
+ *
+ *  Copyright (c) 2018-2019 Mutant Industries ltd.
+ */
+
+#ifndef _DRIVER_IO_PATTERN_H_
+#define _DRIVER_IO_PATTERN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <driver/DMA.h>
+#include <driver/disposable.h>
+#include <driver/IO.h>
+#include <driver/timer.h>
+
+// -------------------------------------------------------------------------------------
+
+#define _IO_pattern_(_pattern)                  ((IO_pattern_t *) (_pattern))
+#define IO_pattern_event_handler(_handler)      ((IO_pattern_event_handler_t) (_handler))
+#define IO_pattern_refill_handler(_handler)     ((IO_pattern_refill_handler_t) (_handler))
+
+/**
+ * Pattern generator public API access
+ */
+#define IO_pattern_write(_pattern, _data, _timing, _length)                         \
+        (_IO_pattern_(_pattern)->write(_IO_pattern_(_pattern), (const void *) (_data), (const uint16_t *) (_timing), _length, false))
+#define IO_pattern_loop(_pattern, _data, _timing, _length)                          \
+        (_IO_pattern_(_pattern)->write(_IO_pattern_(_pattern), (const void *) (_data), (const uint16_t *) (_timing), _length, true))
+#define IO_pattern_stream(_pattern, _data_0, _data_1, _timing_0, _timing_1, _length)                    \
+        (_IO_pattern_(_pattern)->stream(_IO_pattern_(_pattern), (const void *) (_data_0), (const void *) (_data_1),  \
+                (const uint16_t *) (_timing_0), (const uint16_t *) (_timing_1), _length))
+#define IO_pattern_stop(_pattern)                                                   \
+        (_IO_pattern_(_pattern)->stop(_IO_pattern_(_pattern)))
+#define IO_pattern_is_busy(_pattern)                                                \
+        _IO_pattern_(_pattern)->busy
+
+// getter, setter
+#define IO_pattern_on_complete(_pattern) _IO_pattern_(_pattern)->_on_complete
+#define IO_pattern_on_refill(_pattern) _IO_pattern_(_pattern)->_on_refill
+#define IO_pattern_owner(_pattern) _IO_pattern_(_pattern)->_owner
+#define IO_pattern_event_arg(_pattern) _IO_pattern_(_pattern)->_event_arg
+
+/**
+ * Pattern generator public API return codes
+ */
+#define IO_PATTERN_OK                           IO_OK
+#define IO_PATTERN_UNSUPPORTED_OPERATION        IO_UNSUPPORTED_OPERATION
+#define IO_PATTERN_VECTOR_SLOT_UNAVAILABLE      (0x24)
+#define IO_PATTERN_BUSY                         (0x25)
+#define IO_PATTERN_INVALID_CONFIG               (0x27)
+
+// -------------------------------------------------------------------------------------
+
+typedef struct IO_pattern IO_pattern_t;
+typedef void (*IO_pattern_event_handler_t)(void *owner, void *event_arg);
+
+/**
+ * Stream buffer refill handler
+ *  - buffer_index - index of buffer (0 | 1) that has just been played, the other one is playing now
+ *  - return true when the buffer was refilled (it is played after the other one), false to end stream
+ * after the other one
+ */
+typedef bool (*IO_pattern_refill_handler_t)(void *owner, uint8_t buffer_index);
+
+/**
+ * Pattern generator config
+ */
+typedef struct IO_pattern_config {
+    // output port, odd port number (PORT_1 ~ PORT_A...) when word access is used
+    IO_port_driver_t *port;
+    // 16-bit patterns on word port (PORT_A - PORT_F)
+    bool word_access;
+    // MAIN handle of pacing timer, timer must be registered in MC__UP mode
+    Timer_channel_handle_t *period_handle;
+    // pattern step [ticks] in fixed timing, delay of first step in variable timing
+    uint16_t step_period;
+    // DMA channel that transfers patterns to PxOUT
+    DMA_channel_handle_t *DMA_channel;
+    // DMA trigger corresponding to period handle (DMA0TSEL__TA0CCR0...)
+    uint16_t DMA_trigger;
+    // optional DMA channel that transfers step timing to CCR0 (variable timing)
+    DMA_channel_handle_t *DMA_timing_channel;
+    // DMA trigger of timing channel, same as DMA_trigger
+    uint16_t DMA_timing_trigger;
+
+} IO_pattern_config_t;
+
+/**
+ * Pattern generator
+ *  - timer in MC__UP mode, on each CCR0 event DMA writes one pattern to PxOUT (PAOUT...), no CPU load per step,
+ * the first pattern is written step_period after start, pins not driven by pattern (PxDIR = 0) are not affected
+ * by writes but their PxOUT bits (pull resistor selection) are, so patterns must keep them
+ *  - variable timing - timing channel triggered by the same CCR0 event writes CCR0 value of each step, so timing[i]
+ * is the duration of pattern[i] [ticks] - 1, it has to be longer than DMA transfer time of both channels
+ *  - write - one-shot, transfer complete interrupt stops the timer, the last pattern stays on port
+ *  - loop - repeated transfer, no interrupt at all, runs until stopped
+ *  - stream - repeated transfer over two buffers (ping-pong) - DMA source address register is reloaded by hardware
+ * at the end of each block, so switching buffers has no gap, the refill handler is executed once per buffer and has
+ * the time of playing the other buffer to refill the one just played; when the stream ends, the last step is repeated
+ * (port does not change) until the transfer complete interrupt stops the timer, so interrupt latency must be shorter
+ * than one step
+ *  - port pin functions and directions must be set by application
+ */
+struct IO_pattern {
+    // enable dispose(IO_pattern_t *)
+    Disposable_t _disposable;
+    // pattern config
+    IO_pattern_config_t _config;
+    // output port PxOUT register
+    uint16_t _data_register;
+
+    // -------- state --------
+    // stream buffers
+    const void *_data[2];
+    const uint16_t *_timing[2];
+    // stream buffer length
+    uint16_t _length;
+    // copy of last step of ending stream, source of the block reloaded by hardware before generation is stopped
+    uint16_t _last_pattern;
+    uint16_t _last_timing;
+    // index of stream buffer being played
+    uint8_t _playing;
+    // stream or one-shot transfer, transfer complete interrupt enabled
+    bool _stream;
+    // stream ends with buffer being played
+    bool _ending;
+    // transfer complete event handler
+    IO_pattern_event_handler_t _on_complete;
+    // stream buffer refill handler
+    IO_pattern_refill_handler_t _on_refill;
+    // event handler first argument, pattern itself by default
+    void *_owner;
+    // event handler second argument
+    void *_event_arg;
+
+    // -------- public --------
+    // write patterns with fixed (timing = NULL) or variable timing once or in loop
+    uint8_t (*write)(IO_pattern_t *_this, const void *data, const uint16_t *timing, uint16_t length, bool loop);
+    // stream patterns from two buffers of the same length, first data_0, then data_1, then on_refill controlled
+    uint8_t (*stream)(IO_pattern_t *_this, const void *data_0, const void *data_1,
+            const uint16_t *timing_0, const uint16_t *timing_1, uint16_t length);
+    // stop generation, port keeps the last pattern
+    uint8_t (*stop)(IO_pattern_t *_this);
+    // generation running, read-only
+    volatile bool busy;
+
+};
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Initialize pattern generator
+ */
+uint8_t IO_pattern_register(IO_pattern_t *pattern, IO_pattern_config_t *config);
+
+
+#endif /* _DRIVER_IO_PATTERN_H_ */
@@ -0,0 +1,109 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ *  Quadrature encoder decoder - table-driven state machine on A / B pin interrupts, PxIES flipped per edge
+ *
+ *  Copyright (c) 2018-2019 Mutant Industries ltd.
+ */
+
+#ifndef _DRIVER_IO_QUADRATURE_H_
+#define _DRIVER_IO_QUADRATURE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <driver/disposable.h>
+#include <driver/IO.h>
+
+// -------------------------------------------------------------------------------------
+
+#define _IO_quadrature_(_encoder)               ((IO_quadrature_t *) (_encoder))
+
+/**
+ * Quadrature decoder public API access
+ */
+#define IO_quadrature_start(_encoder)                                               \
+        (_IO_quadrature_(_encoder)->start(_IO_quadrature_(_encoder)))
+#define IO_quadrature_stop(_encoder)                                                \
+        (_IO_quadrature_(_encoder)->stop(_IO_quadrature_(_encoder)))
+#define IO_quadrature_get_position(_encoder, _target)                               \
+        (_IO_quadrature_(_encoder)->get_position(_IO_quadrature_(_encoder), (int32_t *) (_target)))
+#define IO_quadrature_set_position(_encoder, _position)                             \
+        (_IO_quadrature_(_encoder)->set_position(_IO_quadrature_(_encoder), (int32_t) (_position)))
+#define IO_quadrature_error_cnt(_encoder)                                           \
+        _IO_quadrature_(_encoder)->error_cnt
+#define IO_quadrature_is_active(_encoder)                                           \
+        _IO_quadrature_(_encoder)->active
+
+/**
+ * Quadrature decoder public API return codes
+ */
+#define IO_QUADRATURE_OK                        IO_OK
+#define IO_QUADRATURE_UNSUPPORTED_OPERATION     IO_UNSUPPORTED_OPERATION
+#define IO_QUADRATURE_VECTOR_SLOT_UNAVAILABLE   (0x24)
+#define IO_QUADRATURE_INVALID_CONFIG            (0x27)
+
+// -------------------------------------------------------------------------------------
+
+typedef struct IO_quadrature IO_quadrature_t;
+
+/**
+ * Quadrature encoder on pin handle the mask of which contains both A and B pins
+ *  - position counts every edge of both channels (4 counts per encoder cycle), increments when A leads B
+ *  - both pins are serviced by one handler execution (with __IO_PORT_COALESCED_DISPATCH__ simultaneous
+ * edges of several encoders on one port are serviced in single interrupt entry), after each edge PxIES of both pins is
+ * set opposite to current level and PxIN is read again until stable, so no edge is lost between flip and flag clear
+ *  - transition of both channels at once (missed edge) is counted in error_cnt, position is not changed
+ *  - velocity is based on timestamps of last two edges sampled on port interrupt entry {@see IO_port_timestamp_source()}
+ */
+struct IO_quadrature {
+    // enable dispose(IO_quadrature_t *)
+    Disposable_t _disposable;
+    // A and B pins handle
+    IO_pin_handle_t *_handle;
+    // channel pins
+    uint8_t _pin_A;
+    uint8_t _pin_B;
+
+    // -------- state --------
+    // last state of channels (A << 1 | B)
+    uint8_t _state;
+    // direction of last counted edge (1 | -1)
+    int8_t _direction;
+    // timestamp of last counted edge
+    uint16_t _timestamp_last;
+    // ticks between last two counted edges, zero if unknown
+    uint16_t _interval;
+    // encoder position
+    volatile int32_t _position;
+
+    // -------- public --------
+    // read channel state, set edge select, enable pin interrupts
+    uint8_t (*start)(IO_quadrature_t *_this);
+    // disable pin interrupts
+    uint8_t (*stop)(IO_quadrature_t *_this);
+    // get position (atomic read)
+    uint8_t (*get_position)(IO_quadrature_t *_this, int32_t *target);
+    // set position (atomic write)
+    uint8_t (*set_position)(IO_quadrature_t *_this, int32_t position);
+    // count of illegal transitions, read-only
+    uint16_t error_cnt;
+    // running state
+    bool active;
+
+};
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Initialize quadrature decoder, pins must be configured as inputs by application
+ */
+uint8_t IO_quadrature_register(IO_quadrature_t *encoder, IO_pin_handle_t *handle, uint8_t pin_A, uint8_t pin_B);
+
+/**
+ * Velocity estimate [counts/s] for given counter value of timestamp source and its frequency [Hz]
+ *  - when the time since last edge exceeds last edge interval (slowing down / stopped), it is used instead
+ *  - speed below (frequency / 65536) counts/s cannot be resolved (timestamp is 16-bit)
+ */
+int32_t IO_quadrature_velocity(IO_quadrature_t *encoder, uint16_t now, uint32_t frequency);
+
+
+#endif /* _DRIVER_IO_QUADRATURE_H_ */
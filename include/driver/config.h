@@ -57,6 +57,16 @@
  */
 //#define __RAM_BASED_INTERRUPT_VECTOR_TABLE_RELOCATE_CNT__     25
 
+/**
+ * enable code region profiling macros PROFILE_BEGIN(id) / PROFILE_END(id) {@see timer/profile.h}
+ */
+//#define __PROFILE_ENABLE__
+
+/**
+ * count of profiled code regions (ids 0 to count - 1), default [8]
+ */
+//#define __PROFILE_REGION_COUNT__      8
+
 // -------------------------------------------------------------------------------------
 
 /**
@@ -79,6 +89,12 @@
  */
 //#define __IO_PORT_LEGACY_SUPPORT__
 
+/**
+ * service all pending pins of port in one interrupt entry, each pin handle is executed once with pin mask
+ * of all its pending pins (instead of one interrupt entry and one execution per pin in PxIV priority order)
+ */
+//#define __IO_PORT_COALESCED_DISPATCH__
+
 /**
  * count of DMA channels, MSP430FR5xx and 6xx define count in __MSP430_HAS_DMA__ already, default [6]
  *  - redefine to save some redundant pointers on DMA driver
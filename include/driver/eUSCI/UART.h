@@ -132,6 +132,7 @@
  */
 #define UART_OK                         EUSCI_OK
 #define UART_UNSUPPORTED_OPERATION      EUSCI_UNSUPPORTED_OPERATION
+#define UART_INVALID_BAUDRATE           (0x24)
 
 // -------------------------------------------------------------------------------------
 
@@ -239,5 +240,13 @@ struct UART_driver {
 
 void UART_driver_register(UART_driver_t *driver, uint16_t base, uint8_t vector_no);
 
+/**
+ * Calculate clock prescaler, modulation stages and oversampling for given clock frequency [Hz] and baudrate
+ *  - follows MSP430 user guide 'Baud-Rate Settings Quick Set Up', clock source of config is not modified
+ *  - allows recalculation of baudrate config when clock frequency differs from nominal
+ *  - UART_INVALID_BAUDRATE when baudrate is zero or higher than clock frequency, config is not modified
+ */
+uint8_t UART_baudrate_config_calculate(UART_baudrate_config_t *config, uint32_t clock_frequency, uint32_t baudrate);
+
 
 #endif /* _DRIVER_EUSCI_UART_H_ */
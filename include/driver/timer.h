@@ -12,6 +12,7 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <driver/cpu.h>
 #include <driver/disposable.h>
 #include <driver/vector.h>
 
@@ -25,6 +26,12 @@
  */
 #define timer_driver_channel_register(_driver, _handle, _handle_type, _dispose_hook)        \
         (_timer_driver_(_driver)->channel_handle_register(_timer_driver_(_driver), _timer_channel_handle_(_handle), _handle_type, _dispose_hook))
+#define timer_driver_reconfigure(_driver, _config, _tick_rate, _tick_rate_new)              \
+        (_timer_driver_(_driver)->reconfigure(_timer_driver_(_driver), _config, (uint16_t) (_tick_rate), (uint16_t) (_tick_rate_new)))
+#define timer_driver_set_compare_latch(_driver, _load_mode, _group, _overflow_handle)      \
+        (_timer_driver_(_driver)->set_compare_latch(_timer_driver_(_driver), _load_mode, _group, _timer_channel_handle_(_overflow_handle)))
+#define timer_driver_compare_latch_commit(_driver)                                          \
+        (_timer_driver_(_driver)->compare_latch_commit(_timer_driver_(_driver)))
 
 #define timer_channel_start(_handle)                                                        \
         (_timer_channel_handle_(_handle)->start(_timer_channel_handle_(_handle)))
@@ -46,8 +53,14 @@
         timer_channel_get_capture_value(_handle)
 #define timer_channel_set_compare_value(_handle, _value)                                    \
         (_timer_channel_handle_(_handle)->set_compare_value(_timer_channel_handle_(_handle), (uint16_t) (_value)))
+#define timer_channel_set_compare_value_latched(_handle, _value)                            \
+        (_timer_channel_handle_(_handle)->set_compare_value_latched(_timer_channel_handle_(_handle), (uint16_t) (_value)))
+#define timer_channel_set_periodic(_handle, _period)                                       \
+        (_timer_channel_handle_(_handle)->set_periodic(_timer_channel_handle_(_handle), (uint16_t) (_period)))
 #define timer_channel_is_active(_handle)                                                    \
         _timer_channel_handle_(_handle)->active
+#define timer_channel_overrun_cnt(_handle)                                                  \
+        _timer_channel_handle_(_handle)->overrun_cnt
 
 /**
  * Timer driver public API return codes
@@ -60,6 +73,34 @@
 
 // -------------------------------------------------------------------------------------
 
+/**
+ * Input divider expansion register
+ */
+#ifdef TAIDEX_0
+#define _TIMER_HAS_IDEX_
+#endif
+
+/**
+ * Standard timer register offsets from base address, compatible across all devices.
+ */
+#ifdef OFS_TAxCTL
+#define OFS_TxCTL           OFS_TAxCTL
+#define OFS_TxCCTL0         OFS_TAxCCTL0
+#define OFS_TxR             OFS_TAxR
+#define OFS_TxCCR0          OFS_TAxCCR0
+#ifdef _TIMER_HAS_IDEX_
+#define OFS_TxEX0           OFS_TAxEX0
+#endif
+#else
+#define OFS_TxCTL           (0x0000)
+#define OFS_TxCCTL0         (0x0002)
+#define OFS_TxR             (0x0010)
+#define OFS_TxCCR0          (0x0012)
+#define OFS_TxEX0           (0x0020)
+#endif
+
+// -------------------------------------------------------------------------------------
+
 /**
  * TIMER_BASE(A, 2)    -> TA2_BASE
  * TIMER_A_BASE(1)     -> TA1_BASE
@@ -102,6 +143,7 @@
 
 typedef struct Timer_driver Timer_driver_t;
 typedef struct Timer_channel_handle Timer_channel_handle_t;
+typedef struct Timer_config Timer_config_t;
 
 typedef enum {
     /**
@@ -163,11 +205,35 @@ struct Timer_driver {
     Vector_slot_t *_slot;
     // active registers count ~ remaining handles count = _available_handles_cnt - _active_handles_cnt
     uint8_t _active_handles_cnt;
+    // CCRn latches present (Timer_B), latched compare update is emulated otherwise
+    bool _compare_latch;
+    // compare latch load mode, CLLD_0 - latching disabled
+    uint16_t _compare_latch_load_mode;
+    // overflow handle applying staged compare values when latching is emulated
+    Timer_channel_handle_t *_compare_latch_handle;
+    // bit mask of CCRn with staged compare value (bit n ~ CCRn)
+    uint8_t _compare_latch_pending;
 
     // -------- public --------
     // register handle of given type with optional dispose hook
     uint8_t (*channel_handle_register)(Timer_driver_t *_this, Timer_channel_handle_t *handle,
           Timer_handle_type handle_type, dispose_function_t dispose_hook);
+    // change clock source, dividers and mode while running, pending compare values are rescaled by tick_rate_new / tick_rate
+    //  - tick rate is the frequency of timer counter in any common unit (e.g. kHz), zero or equal rates disable rescaling
+    //  - MC__CONTINUOUS: distance of pending compare events of active handles from counter is rescaled, so that deadlines are preserved
+    //  - MC__UP | MC__UPDOWN: counter and all compare values (including period in CCR0) are rescaled, count direction is reset
+    //  - capture handles and handles with compare event pending are not affected, period of periodic handles is rescaled
+    uint8_t (*reconfigure)(Timer_driver_t *_this, Timer_config_t *config, uint16_t tick_rate, uint16_t tick_rate_new);
+    // set load event of compare latches and grouping of CCRn latches
+    //  - load mode: CLLD_0 (immediate) | CLLD_1 (counter reaches 0) | CLLD_2 (0 in up/continuous, CCR0 or 0 in up/down)
+    //          | CLLD_3 (counter reaches CCRn)
+    //  - group: TBCLGRP_0 (individual) | TBCLGRP_1 (pairs 1&2, 3&4, 5&6) | TBCLGRP_2 (triplets 1-3, 4-6) | TBCLGRP_3 (all)
+    //  - Timer_B - hardware latches, overflow handle is not used (may be NULL)
+    //  - Timer_A - emulation, staged values are applied by overflow interrupt (counter reaches 0), all staged values
+    // are applied together regardless of group, overflow handle must be registered and is owned by driver until disposed
+    uint8_t (*set_compare_latch)(Timer_driver_t *_this, uint16_t load_mode, uint16_t group, Timer_channel_handle_t *overflow_handle);
+    // publish all compare values staged by set_compare_value_latched(), they take effect together on next load event
+    uint8_t (*compare_latch_commit)(Timer_driver_t *_this);
 
 };
 
@@ -194,6 +260,12 @@ struct Timer_channel_handle {
     dispose_function_t _dispose_hook;
     // backup of original Vector_handle_t.register_handler
     Vector_slot_t *(*_register_handler_parent)(Vector_handle_t *_this, vector_slot_handler_t handler, void *arg_1, void *arg_2);
+    // compare value increment applied on each compare event before handler is executed, zero when periodic mode is disabled
+    uint16_t _period;
+    // compare value staged by set_compare_value_latched()
+    uint16_t _compare_staged;
+    // CCRn index
+    uint8_t _CCRx;
 
     // -------- public --------
     // enable interrupts triggered by handle-specific event, start timer driver if not started yet
@@ -228,6 +300,18 @@ struct Timer_channel_handle {
     uint16_t (*get_capture_value)(Timer_channel_handle_t *_this);
     // set content of CCRn register
     void (*set_compare_value)(Timer_channel_handle_t *_this, uint16_t value);
+    // stage content of CCRn register, applied glitch-free on compare_latch_commit() of driver
+    void (*set_compare_value_latched)(Timer_channel_handle_t *_this, uint16_t value);
+    // ---- periodic mode ----
+    // set period of compare events, zero disables periodic mode (SHARED handles of timer in MC__CONTINUOUS mode only,
+    // TIMER_REFUSED in other modes)
+    //  - CCRn is advanced by period in shared interrupt handler before registered handler is executed, so there is no drift
+    //  - first compare event is armed one period after handle is started
+    //  - periods that have already passed when interrupt is serviced are skipped and counted in overrun_cnt
+    //  - period must be longer than interrupt service margin (8 ticks), TIMER_REFUSED otherwise
+    uint8_t (*set_periodic)(Timer_channel_handle_t *_this, uint16_t period);
+    // count of missed periods in periodic mode, read-only
+    uint16_t overrun_cnt;
     // handle type, read-only
     Timer_handle_type handle_type;
     // running + interrupt enabled state
@@ -239,7 +323,7 @@ struct Timer_channel_handle {
 /**
  * Timer driver init configuration
  */
-typedef struct Timer_config {
+struct Timer_config {
     // TASSEL__TACLK | TASSEL__ACLK | TASSEL__SMCLK | TASSEL__INCLK
     uint16_t clock_source;
     // ID__1  | ID__2 | ID__4 | ID__8
@@ -248,13 +332,21 @@ typedef struct Timer_config {
     uint16_t clock_source_divider_expansion;
     // MC__UP | MC__CONTINUOUS | MC__UPDOWN
     uint8_t mode;
+    // Timer_B instance - CCRn latches present (CLLD, TBCLGRP), on Timer_A latched compare update is emulated
+    bool compare_latch;
 
-} Timer_config_t;
+};
 
 // -------------------------------------------------------------------------------------
 
 void timer_driver_register(Timer_driver_t *driver, Timer_config_t *config, uint16_t base,
             uint8_t main_vector_no, uint8_t shared_vector_no, uint8_t available_handles_cnt);
 
+/**
+ * Counter of handle's timer extended to 32 bits by given overflow count (maintained by overflow handler of the same timer),
+ * overflow not serviced yet is accounted for
+ */
+uint32_t timer_channel_counter_extend(Timer_channel_handle_t *handle, volatile uint16_t *overflow_cnt);
+
 
 #endif /* _DRIVER_TIMER_H_ */
@@ -0,0 +1,110 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ *  Clock calibration - measurement of timer clock frequency by capturing edges of reference clock
+ *
+ *  Copyright (c) 2018-2019 Mutant Industries ltd.
+ */
+
+#ifndef _DRIVER_TIMER_CALIBRATION_H_
+#define _DRIVER_TIMER_CALIBRATION_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <driver/disposable.h>
+#include <driver/timer.h>
+#include <driver/eUSCI/UART.h>
+
+// -------------------------------------------------------------------------------------
+
+#define _timer_calibration_(_calibration)       ((Timer_calibration_t *) (_calibration))
+
+/**
+ * Timer calibration public API access
+ */
+#define timer_calibration_measure(_calibration)                                     \
+        (_timer_calibration_(_calibration)->measure(_timer_calibration_(_calibration)))
+// measured frequency [Hz]
+#define timer_calibration_frequency(_calibration)                                   \
+        _timer_calibration_(_calibration)->frequency
+// deviation of measured frequency from nominal [ppm]
+#define timer_calibration_deviation_ppm(_calibration)                               \
+        _timer_calibration_(_calibration)->deviation_ppm
+// change of measured frequency since previous measurement [Hz]
+#define timer_calibration_drift(_calibration)                                       \
+        _timer_calibration_(_calibration)->drift
+// recompute UART baudrate config (prescaler and modulation) for measured frequency
+#define timer_calibration_UART_baudrate_config(_calibration, _baudrate, _config)    \
+        UART_baudrate_config_calculate(_config, timer_calibration_frequency(_calibration), _baudrate)
+
+/**
+ * Timer calibration public API return codes
+ */
+#define TIMER_CALIBRATION_OK                        TIMER_OK
+#define TIMER_CALIBRATION_UNSUPPORTED_OPERATION     TIMER_UNSUPPORTED_OPERATION
+#define TIMER_CALIBRATION_TIMEOUT                   (0x24)
+#define TIMER_CALIBRATION_CAPTURE_OVERFLOW          (0x25)
+#define TIMER_CALIBRATION_INVALID_CONFIG            (0x27)
+
+// -------------------------------------------------------------------------------------
+
+typedef struct Timer_calibration Timer_calibration_t;
+
+/**
+ * Clock calibration config
+ */
+typedef struct Timer_calibration_config {
+    // capture input internally connected to reference clock (usually CCIS__CCIB, ACLK on most devices, see datasheet)
+    uint16_t input_select;
+    // reference clock frequency [Hz] (32768 when ACLK is sourced by LFXT)
+    uint32_t reference_frequency;
+    // expected frequency of measured clock [Hz]
+    uint32_t nominal_frequency;
+    // total timer input divider (ID * IDEX) so that the frequency of clock before divider is measured
+    uint8_t clock_divider;
+    // count of reference clock periods the measurement is based on
+    uint16_t period_cnt;
+
+} Timer_calibration_config_t;
+
+/**
+ * Clock calibration service
+ *  - timer must be clocked by measured clock (TASSEL__SMCLK), measurement is blocking, reference clock edges are polled
+ * (interrupts are not disabled, long interrupt service during measurement results in capture overflow)
+ *  - with 32768 Hz reference and 32 periods the measurement takes ~1 ms, resolution is 32768 / 32 = 1024 Hz * divider,
+ * increase period_cnt for better resolution
+ */
+struct Timer_calibration {
+    // enable dispose(Timer_calibration_t *)
+    Disposable_t _disposable;
+    // capture handle
+    Timer_channel_handle_t *_handle;
+    // measurement config
+    Timer_calibration_config_t _config;
+
+    // -------- public --------
+    // measure frequency of timer clock
+    uint8_t (*measure)(Timer_calibration_t *_this);
+    // last measured frequency [Hz], read-only
+    uint32_t frequency;
+    // deviation of last measured frequency from nominal [ppm], read-only
+    int32_t deviation_ppm;
+    // difference of last two measured frequencies [Hz], read-only
+    int32_t drift;
+
+};
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Initialize clock calibration service on registered timer handle (not OVERFLOW)
+ *  - frequency is set to nominal frequency until measured
+ */
+void timer_calibration_register(Timer_calibration_t *calibration, Timer_channel_handle_t *handle, Timer_calibration_config_t *config);
+
+/**
+ * Convert time [us] to count of timer ticks for last measured frequency and given timer input divider
+ */
+uint32_t timer_calibration_ticks(Timer_calibration_t *calibration, uint32_t time_us, uint8_t clock_divider);
+
+
+#endif /* _DRIVER_TIMER_CALIBRATION_H_ */
@@ -0,0 +1,153 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ *  Streaming input capture - CCRn capture values transferred by DMA to circular buffer, period / frequency extraction
+ *
+ *  Copyright (c) 2018-2019 Mutant Industries ltd.
+ */
+
+#ifndef _DRIVER_TIMER_CAPTURE_H_
+#define _DRIVER_TIMER_CAPTURE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <driver/DMA.h>
+#include <driver/disposable.h>
+#include <driver/timer.h>
+
+// -------------------------------------------------------------------------------------
+
+#define _timer_capture_stream_(_stream)         ((Timer_capture_stream_t *) (_stream))
+
+/**
+ * Timer capture stream public API access
+ */
+#define timer_capture_stream_start(_stream, _mode, _input_select)                   \
+        (_timer_capture_stream_(_stream)->start(_timer_capture_stream_(_stream), _mode, _input_select))
+#define timer_capture_stream_stop(_stream)                                          \
+        (_timer_capture_stream_(_stream)->stop(_timer_capture_stream_(_stream)))
+#define timer_capture_stream_available(_stream)                                     \
+        (_timer_capture_stream_(_stream)->available(_timer_capture_stream_(_stream)))
+#define timer_capture_stream_read(_stream, _timestamp)                              \
+        (_timer_capture_stream_(_stream)->read(_timer_capture_stream_(_stream), (uint32_t *) (_timestamp)))
+#define timer_capture_stream_measure(_stream, _measurement)                         \
+        (_timer_capture_stream_(_stream)->measure(_timer_capture_stream_(_stream), _measurement))
+#define timer_capture_stream_is_active(_stream)                                     \
+        _timer_capture_stream_(_stream)->active
+
+// statistics
+#define timer_capture_stream_capture_overflow_event_cnt(_stream) _timer_capture_stream_(_stream)->capture_overflow_event_cnt
+#define timer_capture_stream_overrun_cnt(_stream) _timer_capture_stream_(_stream)->overrun_cnt
+
+/**
+ * Frequency [Hz] of measured signal from period in timer ticks and timer clock frequency [Hz]
+ */
+#define timer_capture_frequency(_clock_frequency, _period) \
+        ((_period) ? ((uint32_t) (_clock_frequency)) / ((uint32_t) (_period)) : 0)
+
+/**
+ * Duty cycle of measured signal in permille (CM__BOTH capture mode only)
+ */
+#define timer_capture_duty_permille(_measurement) \
+        ((_measurement)->period ? (uint16_t) (((_measurement)->pulse_width * 1000) / (_measurement)->period) : 0)
+
+/**
+ * Timer capture stream public API return codes
+ */
+#define TIMER_CAPTURE_STREAM_OK                         TIMER_OK
+#define TIMER_CAPTURE_STREAM_UNSUPPORTED_OPERATION      TIMER_UNSUPPORTED_OPERATION
+#define TIMER_CAPTURE_STREAM_VECTOR_SLOT_UNAVAILABLE    (0x24)
+#define TIMER_CAPTURE_STREAM_ACTIVE                     (0x25)
+#define TIMER_CAPTURE_STREAM_EMPTY                      (0x26)
+#define TIMER_CAPTURE_STREAM_OVERRUN                    (0x27)
+
+// -------------------------------------------------------------------------------------
+
+typedef struct Timer_capture_stream Timer_capture_stream_t;
+
+/**
+ * Result of measurement over consecutive samples
+ */
+typedef struct Timer_capture_measurement {
+    // count of samples the measurement is based on
+    uint16_t sample_cnt;
+    // average period [timer ticks]
+    uint32_t period;
+    // average time from rising to falling edge [timer ticks], CM__BOTH capture mode only
+    uint32_t pulse_width;
+
+} Timer_capture_measurement_t;
+
+/**
+ * Streaming input capture
+ *  - each capture event of given channel triggers DMA transfer of CCRn register to circular buffer,
+ * DMA interrupt is triggered only once per buffer wrap
+ *  - samples are extended to 32-bit timestamps when read:
+ *    - if overflow handle is set, then the overflow handle is used to count timer overflows (timer should be
+ * in MC__CONTINUOUS mode), samples must be read within one timer period after captured
+ *    - otherwise consecutive samples must be less than one timer period apart
+ */
+struct Timer_capture_stream {
+    // enable dispose(Timer_capture_stream_t *)
+    Disposable_t _disposable;
+    // capture channel handle
+    Timer_channel_handle_t *_handle;
+    // optional overflow handle of the same timer
+    Timer_channel_handle_t *_overflow_handle;
+    // DMA channel that transfers capture values
+    DMA_channel_handle_t *_DMA_channel;
+    // DMA trigger corresponding to capture handle (DMA0TSEL__TA0CCR2, DMA0TSEL__TA1CCR0...)
+    uint16_t _DMA_trigger;
+    // circular buffer
+    uint16_t *_buffer;
+    // circular buffer length (count of samples)
+    uint16_t _length;
+
+    // -------- state --------
+    // capture mode (CM__RISING | CM__FALLING | CM__BOTH)
+    uint16_t _capture_mode;
+    // index of next sample to be read
+    uint16_t _read_index;
+    // count of circular buffer wraps on read side
+    uint16_t _read_wrap_cnt;
+    // count of circular buffer wraps on write (DMA) side
+    volatile uint16_t _write_wrap_cnt;
+    // count of timer overflows, when overflow handle is set
+    volatile uint16_t _overflow_cnt;
+    // last timestamp read, when overflow handle is not set
+    uint32_t _timestamp_last;
+    // next sample read is rising edge (CM__BOTH capture mode only)
+    bool _rising_edge_next;
+
+    // -------- public --------
+    // start streaming with given capture mode (CM__RISING | CM__FALLING | CM__BOTH) and input (CCIS__CCIA | CCIS__CCIB...)
+    uint8_t (*start)(Timer_capture_stream_t *_this, uint16_t mode, uint16_t input_select);
+    // stop DMA transfer and capture channel
+    uint8_t (*stop)(Timer_capture_stream_t *_this);
+    // count of samples available to read
+    uint16_t (*available)(Timer_capture_stream_t *_this);
+    // read next sample extended to 32-bit timestamp
+    uint8_t (*read)(Timer_capture_stream_t *_this, uint32_t *timestamp);
+    // consume all available samples and measure average period (and pulse width in CM__BOTH capture mode)
+    uint8_t (*measure)(Timer_capture_stream_t *_this, Timer_capture_measurement_t *measurement);
+    // count of buffer wraps during which capture overflow (COV) occurred, so at least one capture was lost
+    //  - hardware flags overflow, it does not count lost captures, read-only
+    uint16_t capture_overflow_event_cnt;
+    // count of samples lost due to circular buffer overrun, read-only
+    uint16_t overrun_cnt;
+    // streaming state
+    bool active;
+
+};
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Initialize capture stream
+ *  - capture handle, DMA channel and optional overflow handle must be registered already
+ *  - DMA interrupt handler is registered on given DMA channel, overflow handler is registered on overflow handle if set
+ */
+uint8_t timer_capture_stream_register(Timer_capture_stream_t *stream, Timer_channel_handle_t *handle, Timer_channel_handle_t *overflow_handle,
+        DMA_channel_handle_t *DMA_channel, uint16_t DMA_trigger, uint16_t *buffer, uint16_t length);
+
+
+#endif /* _DRIVER_TIMER_CAPTURE_H_ */
@@ -0,0 +1,113 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ *  Cascaded timers - 32-bit hardware counter built from two 16-bit timers
+ *
+ *  Copyright (c) 2018-2019 Mutant Industries ltd.
+ */
+
+#ifndef _DRIVER_TIMER_CASCADE_H_
+#define _DRIVER_TIMER_CASCADE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <driver/disposable.h>
+#include <driver/timer.h>
+
+// -------------------------------------------------------------------------------------
+
+#define _timer_cascade_(_cascade)               ((Timer_cascade_t *) (_cascade))
+#define timer_cascade_event_handler(_handler)   ((timer_cascade_event_handler_t) (_handler))
+
+/**
+ * Timer cascade public API access
+ */
+#define timer_cascade_start(_cascade)                                               \
+        (_timer_cascade_(_cascade)->start(_timer_cascade_(_cascade)))
+#define timer_cascade_stop(_cascade)                                                \
+        (_timer_cascade_(_cascade)->stop(_timer_cascade_(_cascade)))
+#define timer_cascade_get_counter(_cascade, _target)                                \
+        (_timer_cascade_(_cascade)->get_counter(_timer_cascade_(_cascade), (uint32_t *) (_target)))
+#define timer_cascade_set_compare_value(_cascade, _value)                           \
+        (_timer_cascade_(_cascade)->set_compare_value(_timer_cascade_(_cascade), (uint32_t) (_value)))
+#define timer_cascade_compare_cancel(_cascade)                                      \
+        (_timer_cascade_(_cascade)->compare_cancel(_timer_cascade_(_cascade)))
+#define timer_cascade_is_active(_cascade)                                           \
+        _timer_cascade_(_cascade)->active
+
+// getter, setter
+#define timer_cascade_on_compare(_cascade) _timer_cascade_(_cascade)->_on_compare
+#define timer_cascade_owner(_cascade) _timer_cascade_(_cascade)->_owner
+#define timer_cascade_event_arg(_cascade) _timer_cascade_(_cascade)->_event_arg
+
+/**
+ * Timer cascade public API return codes
+ */
+#define TIMER_CASCADE_OK                        TIMER_OK
+#define TIMER_CASCADE_UNSUPPORTED_OPERATION     TIMER_UNSUPPORTED_OPERATION
+#define TIMER_CASCADE_VECTOR_SLOT_UNAVAILABLE   (0x24)
+#define TIMER_CASCADE_NOT_ACTIVE                (0x26)
+
+// -------------------------------------------------------------------------------------
+
+typedef struct Timer_cascade Timer_cascade_t;
+typedef void (*timer_cascade_event_handler_t)(void *owner, void *event_arg);
+
+/**
+ * Two timers chained to 32-bit counter
+ *  - low timer runs in MC__CONTINUOUS mode, on each low timer overflow the carry handle output (OUTMOD_7 with CCR0 = 0)
+ * generates one rising edge, which has to be routed (externally, by pin) to TxCLK input of high timer
+ *  - high timer must be registered with TASSEL__TACLK clock source in MC__CONTINUOUS mode
+ *  - port pin function of carry handle output and TxCLK input must be set by application
+ *  - 32-bit compare is done in two stages - high handle compare on high word, then low compare handle on low word,
+ * so that there is no overflow interrupt and the compare event is generated by hardware
+ */
+struct Timer_cascade {
+    // enable dispose(Timer_cascade_t *)
+    Disposable_t _disposable;
+    // CCR0 (MAIN) handle of low timer, CCR0 = 0 defines the carry edge
+    Timer_channel_handle_t *_low_main_handle;
+    // CCRn handle of low timer the output of which drives high timer clock
+    Timer_channel_handle_t *_carry_handle;
+    // optional CCRn handle of low timer, second stage of 32-bit compare
+    Timer_channel_handle_t *_low_compare_handle;
+    // any compare handle of high timer, first stage of 32-bit compare
+    Timer_channel_handle_t *_high_handle;
+
+    // -------- state --------
+    // 32-bit compare value
+    uint32_t _compare_value;
+    // compare event handler
+    timer_cascade_event_handler_t _on_compare;
+    // compare event handler first argument, cascade itself by default
+    void *_owner;
+    // compare event handler second argument
+    void *_event_arg;
+
+    // -------- public --------
+    // start both timers
+    uint8_t (*start)(Timer_cascade_t *_this);
+    // stop both timers, cancel pending compare
+    uint8_t (*stop)(Timer_cascade_t *_this);
+    // get content of 32-bit counter, carry race is handled
+    uint8_t (*get_counter)(Timer_cascade_t *_this, uint32_t *target);
+    // set 32-bit compare value, on_compare handler is executed once when reached (immediately if already passed)
+    uint8_t (*set_compare_value)(Timer_cascade_t *_this, uint32_t value);
+    // cancel pending compare
+    uint8_t (*compare_cancel)(Timer_cascade_t *_this);
+    // running state
+    bool active;
+
+};
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Initialize timer cascade
+ *  - all handles must be registered already, low compare handle is optional (if not set then compare is not supported)
+ *  - interrupt handlers are registered on high handle and low compare handle
+ */
+uint8_t timer_cascade_register(Timer_cascade_t *cascade, Timer_channel_handle_t *low_main_handle, Timer_channel_handle_t *carry_handle,
+        Timer_channel_handle_t *low_compare_handle, Timer_channel_handle_t *high_handle);
+
+
+#endif /* _DRIVER_TIMER_CASCADE_H_ */
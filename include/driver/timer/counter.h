@@ -0,0 +1,131 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ *  Event counter - 32-bit count of external pulses on TxCLK input, gated window frequency measurement
+ *
+ *  Copyright (c) 2018-2019 Mutant Industries ltd.
+ */
+
+#ifndef _DRIVER_TIMER_COUNTER_H_
+#define _DRIVER_TIMER_COUNTER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <driver/disposable.h>
+#include <driver/timer.h>
+
+// -------------------------------------------------------------------------------------
+
+#define _timer_counter_(_counter)               ((Timer_counter_t *) (_counter))
+#define timer_counter_event_handler(_handler)   ((timer_counter_event_handler_t) (_handler))
+
+/**
+ * Event counter public API access
+ */
+#define timer_counter_start(_counter)                                               \
+        (_timer_counter_(_counter)->start(_timer_counter_(_counter)))
+#define timer_counter_stop(_counter)                                                \
+        (_timer_counter_(_counter)->stop(_timer_counter_(_counter)))
+#define timer_counter_get_count(_counter, _target)                                  \
+        (_timer_counter_(_counter)->get_count(_timer_counter_(_counter), (uint32_t *) (_target)))
+#define timer_counter_measure(_counter, _window_ticks, _window_cnt)                 \
+        (_timer_counter_(_counter)->measure(_timer_counter_(_counter), (uint16_t) (_window_ticks), (uint16_t) (_window_cnt)))
+#define timer_counter_is_active(_counter)                                           \
+        _timer_counter_(_counter)->active
+#define timer_counter_is_measuring(_counter)                                        \
+        _timer_counter_(_counter)->measuring
+// count of pulses in last gate window
+#define timer_counter_window_pulse_cnt(_counter)                                    \
+        _timer_counter_(_counter)->window_pulse_cnt
+
+// getter, setter
+#define timer_counter_on_measurement(_counter) _timer_counter_(_counter)->_on_measurement
+#define timer_counter_owner(_counter) _timer_counter_(_counter)->_owner
+#define timer_counter_event_arg(_counter) _timer_counter_(_counter)->_event_arg
+
+/**
+ * Event counter public API return codes
+ */
+#define TIMER_COUNTER_OK                        TIMER_OK
+#define TIMER_COUNTER_UNSUPPORTED_OPERATION     TIMER_UNSUPPORTED_OPERATION
+#define TIMER_COUNTER_VECTOR_SLOT_UNAVAILABLE   (0x24)
+#define TIMER_COUNTER_ACTIVE                    (0x25)
+#define TIMER_COUNTER_NOT_ACTIVE                (0x26)
+#define TIMER_COUNTER_INVALID_WINDOW            (0x27)
+
+// -------------------------------------------------------------------------------------
+
+typedef struct Timer_counter Timer_counter_t;
+typedef void (*timer_counter_event_handler_t)(void *owner, void *event_arg);
+
+/**
+ * Pulses are counted by hardware, no interrupt per pulse
+ *  - counting timer must be registered with TASSEL__TACLK clock source (TxCLK pin) in MC__CONTINUOUS mode, port pin
+ * function of TxCLK input must be set by application, input divider (ID, IDEX) divides counted pulses
+ *  - counter is extended to 32 bits by overflow handle of counting timer, one interrupt per 65536 pulses
+ *  - gated window measurement - pulses counted between two compare events of gate handle on another timer with known
+ * clock, both counter snapshots are taken in the same compare interrupt handler so that the latency cancels out
+ *  - TxCLK is asynchronous to MCLK, counter register is read by voting, TxCLK frequency is limited by datasheet
+ */
+struct Timer_counter {
+    // enable dispose(Timer_counter_t *)
+    Disposable_t _disposable;
+    // overflow handle of counting timer
+    Timer_channel_handle_t *_handle;
+    // optional compare handle (not OVERFLOW) of gate timer
+    Timer_channel_handle_t *_gate_handle;
+
+    // -------- state --------
+    // high word of counter
+    volatile uint16_t _overflow_cnt;
+    // counter value on start
+    uint32_t _count_base;
+    // gate compare event distance
+    uint16_t _window_ticks;
+    // count of gate compare events per window
+    uint16_t _window_cnt;
+    // gate compare events since measurement start
+    uint16_t _window_index;
+    // counter snapshot on window start
+    uint32_t _window_start;
+    // measurement complete handler
+    timer_counter_event_handler_t _on_measurement;
+    // event handler first argument, counter itself by default
+    void *_owner;
+    // event handler second argument
+    void *_event_arg;
+
+    // -------- public --------
+    // start counting from zero
+    uint8_t (*start)(Timer_counter_t *_this);
+    // stop counting, cancel measurement in progress
+    uint8_t (*stop)(Timer_counter_t *_this);
+    // get count of pulses since start, overflow race is handled
+    uint8_t (*get_count)(Timer_counter_t *_this, uint32_t *target);
+    // start gated window measurement of window_ticks * window_cnt gate timer ticks, on_measurement handler is executed
+    // when complete, window_pulse_cnt is set, zero window_ticks is rejected
+    uint8_t (*measure)(Timer_counter_t *_this, uint16_t window_ticks, uint16_t window_cnt);
+    // count of pulses in last measured window, read-only
+    volatile uint32_t window_pulse_cnt;
+    // measurement in progress, read-only
+    volatile bool measuring;
+    // running state
+    bool active;
+
+};
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Initialize event counter
+ *  - overflow handle of counting timer and compare handle of gate timer in MC__CONTINUOUS mode must be registered already,
+ * gate handle is optional (if not set then measurement is not supported)
+ */
+uint8_t timer_counter_register(Timer_counter_t *counter, Timer_channel_handle_t *overflow_handle, Timer_channel_handle_t *gate_handle);
+
+/**
+ * Frequency of counted pulses [Hz] in last measured window for given gate timer frequency [Hz]
+ */
+uint32_t timer_counter_frequency(Timer_counter_t *counter, uint32_t gate_frequency);
+
+
+#endif /* _DRIVER_TIMER_COUNTER_H_ */
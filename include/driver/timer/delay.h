@@ -0,0 +1,111 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ *  Low-power delay - timer compare wake-up from LPM, calibrated cycle loop for short delays
+ *
+ *  Copyright (c) 2018-2019 Mutant Industries ltd.
+ */
+
+#ifndef _DRIVER_TIMER_DELAY_H_
+#define _DRIVER_TIMER_DELAY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <driver/disposable.h>
+#include <driver/timer.h>
+
+// -------------------------------------------------------------------------------------
+
+#define _timer_delay_(_delay)                   ((Timer_delay_t *) (_delay))
+
+/**
+ * Timer delay public API access
+ */
+#define timer_delay_us(_delay, _time_us)                                            \
+        (_timer_delay_(_delay)->delay_us(_timer_delay_(_delay), (uint32_t) (_time_us)))
+#define timer_delay_sleep_until(_delay, _timestamp)                                 \
+        (_timer_delay_(_delay)->sleep_until(_timer_delay_(_delay), (uint16_t) (_timestamp)))
+#define timer_delay_timestamp(_delay)                                               \
+        (_timer_delay_(_delay)->timestamp(_timer_delay_(_delay)))
+#define timer_delay_calibrate(_delay)                                               \
+        (_timer_delay_(_delay)->calibrate(_timer_delay_(_delay)))
+#define timer_delay_wake_latency(_delay)                                            \
+        _timer_delay_(_delay)->wake_latency
+#define timer_delay_threshold_us(_delay)                                            \
+        _timer_delay_(_delay)->threshold_us
+
+/**
+ * Timer delay public API return codes
+ */
+#define TIMER_DELAY_OK                          TIMER_OK
+#define TIMER_DELAY_UNSUPPORTED_OPERATION       TIMER_UNSUPPORTED_OPERATION
+#define TIMER_DELAY_INVALID_HANDLE              (0x24)
+#define TIMER_DELAY_ALREADY_REGISTERED          (0x25)
+#define TIMER_DELAY_CALIBRATION_FAILED          (0x27)
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Delay service config
+ */
+typedef struct Timer_delay_config {
+    // frequency of timer counter [Hz]
+    uint32_t timer_frequency;
+    // status register bits of low power mode entered during delay, timer clock must stay active
+    // (LPM0_bits for SMCLK, up to LPM3_bits for ACLK)
+    uint16_t low_power_mode;
+    // delays shorter than threshold [us] are performed by cycle loop, zero - derived from measured wake latency
+    uint16_t threshold_us;
+
+} Timer_delay_config_t;
+
+typedef struct Timer_delay Timer_delay_t;
+
+/**
+ * Delay service
+ *  - compare interrupt is serviced by raw interrupt handler that clears LPM bits on exit, so the service
+ * must not be used from interrupt service routines
+ *  - raw interrupt handler takes no argument, so only one service can be registered at a time (until disposed)
+ */
+struct Timer_delay {
+    // enable dispose(Timer_delay_t *)
+    Disposable_t _disposable;
+    // MAIN handle of timer in MC__CONTINUOUS mode, compare interrupt wakes the CPU
+    Timer_channel_handle_t *_handle;
+    // service config
+    Timer_delay_config_t _config;
+
+    // -------- state --------
+    // cycle loop iterations per microsecond, fixed point (8 fractional bits)
+    uint16_t _loop_iterations_q8;
+    // set by compare interrupt
+    volatile bool _expired;
+
+    // -------- public --------
+    // wait for given time, sleep in configured LPM if longer than threshold
+    //  - interrupts are serviced during sleep, interrupt that clears LPM bits on exit does not shorten the delay
+    void (*delay_us)(Timer_delay_t *_this, uint32_t time_us);
+    // sleep in configured LPM until timer counter reaches timestamp (at most 0x7FFF ticks ahead)
+    void (*sleep_until)(Timer_delay_t *_this, uint16_t timestamp);
+    // current timer counter - base of sleep_until() timestamps
+    uint16_t (*timestamp)(Timer_delay_t *_this);
+    // calibrate cycle loop and wake latency (threshold_us if not set in config), repeat after clock change
+    uint8_t (*calibrate)(Timer_delay_t *_this);
+    // ticks from compare event to CPU running again, compare is armed in advance by this value, read-only
+    uint16_t wake_latency;
+    // delays shorter than threshold [us] are performed by cycle loop, read-only
+    uint16_t threshold_us;
+
+};
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Initialize delay service on MAIN handle (raw interrupt handler is registered on its vector) and calibrate
+ *  - timer must run in MC__CONTINUOUS mode, handle is owned by the service
+ *  - handle is started, so the timer keeps running as long as the service is used
+ *  - TIMER_DELAY_ALREADY_REGISTERED if other service is registered already
+ */
+uint8_t timer_delay_register(Timer_delay_t *delay, Timer_channel_handle_t *handle, Timer_delay_config_t *config);
+
+
+#endif /* _DRIVER_TIMER_DELAY_H_ */
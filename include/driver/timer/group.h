@@ -0,0 +1,107 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ *  Timer group - synchronized start and phase alignment of multiple hardware timers
+ *
+ *  Copyright (c) 2018-2019 Mutant Industries ltd.
+ */
+
+#ifndef _DRIVER_TIMER_GROUP_H_
+#define _DRIVER_TIMER_GROUP_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <driver/disposable.h>
+#include <driver/timer.h>
+
+// -------------------------------------------------------------------------------------
+
+#define _timer_group_(_group)                   ((Timer_group_t *) (_group))
+
+/**
+ * Timer group public API access
+ */
+#define timer_group_start(_group)                                                   \
+        (_timer_group_(_group)->start(_timer_group_(_group)))
+#define timer_group_stop(_group)                                                    \
+        (_timer_group_(_group)->stop(_timer_group_(_group)))
+#define timer_group_rephase(_group, _member_index, _phase)                          \
+        (_timer_group_(_group)->rephase(_timer_group_(_group), _member_index, (uint16_t) (_phase)))
+#define timer_group_skew(_group)                                                    \
+        _timer_group_(_group)->skew
+#define timer_group_is_active(_group)                                               \
+        _timer_group_(_group)->active
+
+/**
+ * Timer group public API return codes
+ */
+#define TIMER_GROUP_OK                          TIMER_OK
+#define TIMER_GROUP_UNSUPPORTED_OPERATION       TIMER_UNSUPPORTED_OPERATION
+#define TIMER_GROUP_INVALID_MEMBER              (0x24)
+#define TIMER_GROUP_ACTIVE                      (0x25)
+#define TIMER_GROUP_NOT_ACTIVE                  (0x26)
+
+/**
+ * Max count of timers in group
+ */
+#define TIMER_GROUP_MEMBER_MAX                  (8)
+
+// -------------------------------------------------------------------------------------
+
+typedef struct Timer_group Timer_group_t;
+
+/**
+ * Single timer of group
+ */
+typedef struct Timer_group_member {
+    // any registered compare handle of member timer (not OVERFLOW), started and stopped with group
+    Timer_channel_handle_t *handle;
+    // counter value preloaded before start - phase offset
+    uint16_t phase;
+    // CCRn value of handle preloaded before start
+    uint16_t compare_value;
+
+} Timer_group_member_t;
+
+/**
+ * Timers started in the same cycle with defined phase offsets
+ *  - all members are halted, counters and compare values preloaded and then started by back-to-back writes of TxCTL
+ * in single critical section, the first member is the phase reference
+ *  - member timers are owned by the group - counter is rewritten on start even if other handles are active already
+ *  - skew is measured by reading reference counter before and after member counter, it is accurate to one tick
+ * when timer clocks are synchronous to MCLK
+ *  - phase is reduced modulo counter period of member (CCR0 + 1 in MC__UP, 0x10000 in MC__CONTINUOUS)
+ */
+struct Timer_group {
+    // enable dispose(Timer_group_t *)
+    Disposable_t _disposable;
+    // member array
+    Timer_group_member_t *_members;
+    // member count
+    uint8_t _member_cnt;
+
+    // -------- public --------
+    // preload and start all members
+    uint8_t (*start)(Timer_group_t *_this);
+    // stop all members
+    uint8_t (*stop)(Timer_group_t *_this);
+    // change phase of running member relative to the first member (member_index > 0)
+    uint8_t (*rephase)(Timer_group_t *_this, uint8_t member_index, uint16_t phase);
+    // measured lag [ticks] of last member after start or of rephased member after rephase, read-only
+    int16_t skew;
+    // running state
+    bool active;
+
+};
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Initialize timer group
+ *  - members must belong to different timers, handles must be registered and set to compare mode already
+ *  - timers in MC__UPDOWN mode are refused (TIMER_GROUP_INVALID_MEMBER) - count direction cannot be preloaded
+ *  - member array must stay valid until group is disposed
+ */
+uint8_t timer_group_register(Timer_group_t *group, Timer_group_member_t *members, uint8_t member_cnt);
+
+
+#endif /* _DRIVER_TIMER_GROUP_H_ */
@@ -0,0 +1,161 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ *  Motion engine - stepper step generation with acceleration profiles, DMA-fed compare channels
+ *
+ *  Copyright (c) 2018-2019 Mutant Industries ltd.
+ */
+
+#ifndef _DRIVER_TIMER_MOTION_H_
+#define _DRIVER_TIMER_MOTION_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <driver/DMA.h>
+#include <driver/disposable.h>
+#include <driver/timer.h>
+
+// -------------------------------------------------------------------------------------
+
+#define _timer_motion_(_motion)                 ((Timer_motion_t *) (_motion))
+#define timer_motion_event_handler(_handler)    ((timer_motion_event_handler_t) (_handler))
+
+/**
+ * Motion engine public API access
+ */
+#define timer_motion_move(_motion, _steps)                                          \
+        (_timer_motion_(_motion)->move(_timer_motion_(_motion), (uint32_t *) (_steps)))
+#define timer_motion_stop(_motion)                                                  \
+        (_timer_motion_(_motion)->stop(_timer_motion_(_motion)))
+#define timer_motion_is_active(_motion)                                             \
+        _timer_motion_(_motion)->active
+
+// getter, setter
+#define timer_motion_on_complete(_motion) _timer_motion_(_motion)->_on_complete
+#define timer_motion_owner(_motion) _timer_motion_(_motion)->_owner
+
+/**
+ * Motion engine public API return codes
+ */
+#define TIMER_MOTION_OK                         TIMER_OK
+#define TIMER_MOTION_UNSUPPORTED_OPERATION      TIMER_UNSUPPORTED_OPERATION
+#define TIMER_MOTION_VECTOR_SLOT_UNAVAILABLE    (0x24)
+#define TIMER_MOTION_ACTIVE                     (0x25)
+#define TIMER_MOTION_INVALID_AXIS               (0x27)
+
+// -------------------------------------------------------------------------------------
+
+typedef struct Timer_motion Timer_motion_t;
+typedef void (*timer_motion_event_handler_t)(void *owner, void *event_arg);
+
+typedef enum {
+    /**
+     * Constant acceleration, square of velocity grows linearly with position
+     */
+    MOTION_TRAPEZOIDAL = 1,
+    /**
+     * Square of velocity follows smoothstep of position, acceleration rises from zero and falls back to zero
+     * when max rate is reached, peak acceleration is 1.5 times the given one
+     */
+    MOTION_S_CURVE = 2
+
+} Timer_motion_profile;
+
+/**
+ * Single axis - compare channel the output of which drives step pin
+ */
+typedef struct Timer_motion_axis {
+    // compare handle, output toggled (OUTMOD_4) on each compare event, one step per two toggles
+    Timer_channel_handle_t *handle;
+    // DMA channel transferring compare values to CCRn
+    DMA_channel_handle_t *DMA_channel;
+    // DMA trigger corresponding to handle (DMA0TSEL__TA0CCR2...)
+    uint16_t DMA_trigger;
+    // chunk buffer of 2 * chunk_length compare values
+    uint16_t *buffer;
+    // acceleration ramp - interval of each step [ticks] from start rate to max rate {@see timer_motion_ramp_compute}
+    uint16_t *ramp;
+    uint16_t ramp_length;
+
+    // -------- state --------
+    // engine reference
+    Timer_motion_t *_motion;
+    // count of steps of current move
+    uint32_t _step_cnt;
+    // count of acceleration (and deceleration) steps of current move
+    uint32_t _ramp_steps;
+    // toggles generated so far
+    uint32_t _toggle;
+    // compare value of last generated toggle
+    uint16_t _timestamp;
+    // count of compare values in each chunk, zero - no more values
+    uint16_t _chunk_size[2];
+    // chunk being transferred
+    uint8_t _chunk_index;
+    // move in progress
+    bool _active;
+
+} Timer_motion_axis_t;
+
+/**
+ * Multi-axis step generator
+ *  - each step is two toggles of compare output, compare values are precomputed from ramp table in chunks
+ * and transferred to CCRn by DMA on each compare event, so there is no interrupt per step
+ *  - DMA transfers single chunk (DMADT_0), next chunk is armed and released chunk refilled in DMA interrupt,
+ * a compare event missed while DMA was disabled is recovered by software DMA request
+ *  - interrupt on each chunk completion must be serviced in less than half of the shortest step interval
+ *  - all axes must use handles of the same timer in MC__CONTINUOUS mode, all axes of move start at the same tick
+ *  - step pin function (timer output) and direction pins must be set by application
+ */
+struct Timer_motion {
+    // enable dispose(Timer_motion_t *)
+    Disposable_t _disposable;
+    // axes array
+    Timer_motion_axis_t *_axes;
+    // axes count
+    uint8_t _axis_cnt;
+    // count of compare values in one chunk
+    uint16_t _chunk_length;
+    // delay of move start [ticks], must cover arming of all axes
+    uint16_t _start_delay;
+
+    // -------- state --------
+    // count of axes the move of which is in progress
+    uint8_t _active_axis_cnt;
+    // move complete event handler
+    timer_motion_event_handler_t _on_complete;
+    // event handler first argument, engine itself by default
+    void *_owner;
+
+    // -------- public --------
+    // start coordinated move of all axes, steps - array of step count per axis (zero - axis idle)
+    uint8_t (*move)(Timer_motion_t *_this, uint32_t *steps);
+    // abort move of all axes
+    uint8_t (*stop)(Timer_motion_t *_this);
+    // move in progress state
+    bool active;
+
+};
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Fill ramp table with step intervals [ticks] from start rate to max rate [steps/s], return count of steps to reach max rate
+ *  - ramp table is computed once per profile and can be shared by axes, computation is not time-critical
+ *  - if the table is too short, then the max rate is never reached
+ *  - zero acceleration or max rate below start rate is rejected, no step is computed (0 is returned)
+ */
+uint16_t timer_motion_ramp_compute(uint16_t *ramp, uint16_t length, Timer_motion_profile profile, uint32_t timer_frequency,
+        uint16_t start_rate, uint16_t max_rate, uint32_t acceleration);
+
+/**
+ * Initialize motion engine
+ *  - handles and DMA channels of all axes must be registered, one vector slot (shared by all DMA channels) is required,
+ * shared timer vector slot is required for end-of-move detection
+ *  - axes array must stay valid until disposed
+ *  - chunk length must be at least 2 compare values
+ */
+uint8_t timer_motion_register(Timer_motion_t *motion, Timer_motion_axis_t *axes, uint8_t axis_cnt, uint16_t chunk_length,
+        uint16_t start_delay);
+
+
+#endif /* _DRIVER_TIMER_MOTION_H_ */
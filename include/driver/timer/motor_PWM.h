@@ -0,0 +1,131 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ *  Motor PWM - center-aligned complementary PWM pairs with dead time on timer in MC__UPDOWN mode
+ *
+ *  Copyright (c) 2018-2019 Mutant Industries ltd.
+ */
+
+#ifndef _DRIVER_TIMER_MOTOR_PWM_H_
+#define _DRIVER_TIMER_MOTOR_PWM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <driver/disposable.h>
+#include <driver/timer.h>
+
+// -------------------------------------------------------------------------------------
+
+#define _timer_motor_PWM_(_motor)               ((Timer_motor_PWM_t *) (_motor))
+
+/**
+ * Motor PWM public API access
+ */
+#define timer_motor_PWM_start(_motor)                                               \
+        (_timer_motor_PWM_(_motor)->start(_timer_motor_PWM_(_motor)))
+#define timer_motor_PWM_stop(_motor)                                                \
+        (_timer_motor_PWM_(_motor)->stop(_timer_motor_PWM_(_motor)))
+#define timer_motor_PWM_set_duty(_motor, _duty)                                     \
+        (_timer_motor_PWM_(_motor)->set_duty(_timer_motor_PWM_(_motor), (uint16_t *) (_duty)))
+#define timer_motor_PWM_is_active(_motor)                                           \
+        _timer_motor_PWM_(_motor)->active
+
+/**
+ * Motor PWM public API return codes
+ */
+#define TIMER_MOTOR_PWM_OK                      TIMER_OK
+#define TIMER_MOTOR_PWM_UNSUPPORTED_OPERATION   TIMER_UNSUPPORTED_OPERATION
+#define TIMER_MOTOR_PWM_ACTIVE                  (0x25)
+#define TIMER_MOTOR_PWM_INVALID_CONFIG          (0x27)
+
+/**
+ * Max count of phases (half-bridges)
+ */
+#define TIMER_MOTOR_PWM_PHASE_MAX               (3)
+
+// -------------------------------------------------------------------------------------
+
+typedef struct Timer_motor_PWM Timer_motor_PWM_t;
+
+/**
+ * Half-bridge handles
+ *  - on Timer_B allocate CCRn pairs (1, 2), (3, 4), (5, 6) so that both CCRn of phase share one latch group
+ */
+typedef struct Timer_motor_PWM_phase {
+    // high side switch, OUTMOD_6 - active while counter is above its compare value
+    Timer_channel_handle_t *high_handle;
+    // low side switch, OUTMOD_2 - active while counter is below its compare value
+    Timer_channel_handle_t *low_handle;
+
+} Timer_motor_PWM_phase_t;
+
+/**
+ * Motor PWM config
+ */
+typedef struct Timer_motor_PWM_config {
+    // CCR0 ~ half of PWM period [ticks], PWM frequency = timer frequency / (2 * period)
+    uint16_t period;
+    // delay between switch-off of one side and switch-on of the other side [ticks], at most period - 2
+    uint16_t dead_time;
+    // half-bridges
+    Timer_motor_PWM_phase_t *phases;
+    uint8_t phase_cnt;
+    // optional compare handle the output of which triggers current sampling (ADC / DMA trigger source)
+    Timer_channel_handle_t *trigger_handle;
+    // trigger output (OUTMOD_6) rises when counter passes trigger point counting up, falls when counting down
+    //  - period - dead_time / 2 ~ center of high side on-time, small value ~ center of low side on-time
+    uint16_t trigger_point;
+
+} Timer_motor_PWM_config_t;
+
+/**
+ * Center-aligned complementary PWM, generated by hardware without per-period interrupts
+ *  - timer must be registered in MC__UPDOWN mode, CCR0 (MAIN handle) defines period
+ *  - duty is on-time of high side per half period, compare values of phase are high = period - duty,
+ * low = high - dead_time, so both switches are off for dead_time ticks around each edge
+ *  - duty is clamped to [1, period - dead_time - 1], so that neither compare value reaches CCR0 or 0 where
+ * the output would not toggle back (shoot-through)
+ *  - duty of all phases is updated atomically on next counter zero by compare latches (CLLD_1, TBCLGRP_1) on Timer_B,
+ * emulated by one overflow interrupt per update on Timer_A
+ *  - initial compare values are loaded immediately on start, period in CCR0 is never latched
+ *  - all outputs are low when stopped, port pin function of outputs must be set by application
+ */
+struct Timer_motor_PWM {
+    // enable dispose(Timer_motor_PWM_t *)
+    Disposable_t _disposable;
+    // CCR0 handle
+    Timer_channel_handle_t *_main_handle;
+    // half-bridges
+    Timer_motor_PWM_phase_t *_phases;
+    uint8_t _phase_cnt;
+    // optional current sampling trigger handle
+    Timer_channel_handle_t *_trigger_handle;
+    uint16_t _trigger_point;
+    // half period [ticks]
+    uint16_t _period;
+    // dead time [ticks]
+    uint16_t _dead_time;
+
+    // -------- public --------
+    // start PWM, initial duty of all phases is minimal (low side on)
+    uint8_t (*start)(Timer_motor_PWM_t *_this);
+    // stop PWM, all outputs low
+    uint8_t (*stop)(Timer_motor_PWM_t *_this);
+    // set duty of all phases (array of phase_cnt values), applied together on next counter zero
+    uint8_t (*set_duty)(Timer_motor_PWM_t *_this, uint16_t *duty);
+    // running state
+    bool active;
+
+};
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Initialize motor PWM
+ *  - all handles must be registered on the same timer, compare latch of driver is configured (load on counter zero)
+ *  - overflow handle is required on Timer_A (latch emulation), NULL on Timer_B
+ */
+uint8_t timer_motor_PWM_register(Timer_motor_PWM_t *motor, Timer_channel_handle_t *main_handle, Timer_channel_handle_t *overflow_handle,
+        Timer_motor_PWM_config_t *config);
+
+
+#endif /* _DRIVER_TIMER_MOTOR_PWM_H_ */
@@ -0,0 +1,110 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ *  Code region profiling - cycle count statistics of instrumented code regions
+ *
+ *  Copyright (c) 2018-2019 Mutant Industries ltd.
+ */
+
+#ifndef _DRIVER_TIMER_PROFILE_H_
+#define _DRIVER_TIMER_PROFILE_H_
+
+#include <stdint.h>
+#include <driver/config.h>
+#include <driver/cpu.h>
+#include <driver/timer.h>
+
+// -------------------------------------------------------------------------------------
+
+#ifndef __PROFILE_REGION_COUNT__
+#define __PROFILE_REGION_COUNT__        8
+#endif
+
+#ifndef __PROFILE_ENABLE__
+
+#define PROFILE_BEGIN(_id)
+#define PROFILE_END(_id)
+
+#else
+
+/**
+ * Profiled region access by id (0 to __PROFILE_REGION_COUNT__ - 1)
+ */
+#define profile_region(_id)             (&profile_region_table[_id])
+
+/**
+ * Region instrumentation - counter is read as the last instruction of PROFILE_BEGIN and as the first one of PROFILE_END,
+ * so that the remaining instrumentation cost is constant and subtracted by profile_region_end()
+ */
+#define PROFILE_BEGIN(_id) _profile_region_begin(profile_region(_id))
+#define PROFILE_END(_id) _profile_region_end(profile_region(_id))
+
+#define _profile_region_begin(_region) do {                                             \
+    (_region)->_overhead_snapshot = profile_overhead_accumulated;                       \
+    (_region)->_start = hw_register_16(profile_counter_register);                       \
+} while (0)
+
+#define _profile_region_end(_region)                                                    \
+    profile_region_end(_region, hw_register_16(profile_counter_register))
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Statistics of single profiled region [timer ticks]
+ */
+typedef struct Profile_region {
+    // count of region executions
+    uint16_t count;
+    // shortest execution
+    uint16_t min;
+    // longest execution
+    uint16_t max;
+    // sum of all executions
+    uint32_t total;
+
+    // -------- state --------
+    // counter at region begin
+    uint16_t _start;
+    // overhead accumulator at region begin, nested regions overhead is the difference at region end
+    uint16_t _overhead_snapshot;
+
+} Profile_region_t;
+
+/**
+ * Profiled regions, indexed by region id
+ */
+extern Profile_region_t profile_region_table[__PROFILE_REGION_COUNT__];
+
+/**
+ * Address of counter register (TxR) of profiling timer
+ */
+extern uint16_t profile_counter_register;
+
+/**
+ * Total overhead of all regions ended so far, seen from enclosing regions
+ */
+extern uint16_t profile_overhead_accumulated;
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Start profiling timer and calibrate instrumentation overhead
+ *  - timer must be registered with TASSEL__SMCLK, ID__1 (and TAIDEX_0) in MC__CONTINUOUS mode, SMCLK sourced
+ * by the same oscillator as MCLK without divider, so that one tick equals one CPU cycle
+ *  - any registered handle of that timer (not OVERFLOW) can be passed, it is switched to compare mode, interrupt disabled
+ *  - region length must not exceed 0xFFFF cycles, interrupts serviced within region are counted as well
+ */
+void profile_init(Timer_channel_handle_t *handle);
+
+/**
+ * Reset statistics of all regions
+ */
+void profile_reset(void);
+
+/**
+ * Update region statistics, subtract own overhead and overhead of nested regions
+ */
+void profile_region_end(Profile_region_t *region, uint16_t counter);
+
+#endif /* __PROFILE_ENABLE__ */
+
+#endif /* _DRIVER_TIMER_PROFILE_H_ */
@@ -0,0 +1,114 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ *  One-shot pulse generator - pulse of given delay and width on timer output, generated by hardware
+ *
+ *  Copyright (c) 2018-2019 Mutant Industries ltd.
+ */
+
+#ifndef _DRIVER_TIMER_PULSE_H_
+#define _DRIVER_TIMER_PULSE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <driver/disposable.h>
+#include <driver/timer.h>
+
+// -------------------------------------------------------------------------------------
+
+#define _timer_pulse_(_pulse)                   ((Timer_pulse_t *) (_pulse))
+#define timer_pulse_event_handler(_handler)     ((timer_pulse_event_handler_t) (_handler))
+
+/**
+ * Pulse generator public API access
+ */
+#define timer_pulse_set_shape(_pulse, _width, _interval, _pulse_cnt)                \
+        (_timer_pulse_(_pulse)->set_shape(_timer_pulse_(_pulse), (uint16_t) (_width), (uint16_t) (_interval), (uint16_t) (_pulse_cnt)))
+#define timer_pulse_fire(_pulse, _delay)                                            \
+        (_timer_pulse_(_pulse)->fire(_timer_pulse_(_pulse), (uint16_t) (_delay)))
+#define timer_pulse_fire_at(_pulse, _reference, _delay)                             \
+        (_timer_pulse_(_pulse)->fire_at(_timer_pulse_(_pulse), (uint16_t) (_reference), (uint16_t) (_delay)))
+#define timer_pulse_cancel(_pulse)                                                  \
+        (_timer_pulse_(_pulse)->cancel(_timer_pulse_(_pulse)))
+#define timer_pulse_is_active(_pulse)                                               \
+        _timer_pulse_(_pulse)->active
+
+// getter, setter
+#define timer_pulse_on_complete(_pulse) _timer_pulse_(_pulse)->_on_complete
+#define timer_pulse_owner(_pulse) _timer_pulse_(_pulse)->_owner
+#define timer_pulse_event_arg(_pulse) _timer_pulse_(_pulse)->_event_arg
+
+/**
+ * Pulse generator public API return codes
+ */
+#define TIMER_PULSE_OK                          TIMER_OK
+#define TIMER_PULSE_UNSUPPORTED_OPERATION       TIMER_UNSUPPORTED_OPERATION
+#define TIMER_PULSE_VECTOR_SLOT_UNAVAILABLE     (0x24)
+#define TIMER_PULSE_ACTIVE                      (0x25)
+#define TIMER_PULSE_DEADLINE_MISSED             (0x27)
+#define TIMER_PULSE_INVALID_CONFIG              (0x28)
+
+// -------------------------------------------------------------------------------------
+
+typedef struct Timer_pulse Timer_pulse_t;
+typedef void (*timer_pulse_event_handler_t)(void *owner, void *event_arg);
+
+/**
+ * One-shot (or repeated) pulse on compare handle output of timer in MC__CONTINUOUS mode
+ *  - leading edge is set by hardware on compare event (OUTMOD_1 / OUTMOD_5 for active low), the interrupt of leading
+ * edge arms trailing edge (OUTMOD_5 / OUTMOD_1) on next compare, so edge timing has no jitter, however width
+ * (and interval - width) must exceed the interrupt latency
+ *  - delay is relative either to current counter or to given reference timestamp (e.g. captured event on the same timer)
+ *  - on_complete is executed after trailing edge of last pulse, pulse can be fired again from within the handler
+ *  - port pin function of handle output must be set by application
+ */
+struct Timer_pulse {
+    // enable dispose(Timer_pulse_t *)
+    Disposable_t _disposable;
+    // output compare handle
+    Timer_channel_handle_t *_handle;
+    // output level between pulses is high
+    bool _active_low;
+
+    // -------- state --------
+    // pulse width [ticks]
+    uint16_t _width;
+    // distance of leading edges of repeated pulses [ticks]
+    uint16_t _interval;
+    // count of pulses per fire
+    uint16_t _pulse_cnt;
+    // pulses not finished yet
+    uint16_t _pulse_remaining;
+    // next compare event is leading edge
+    bool _leading;
+    // last pulse finished handler
+    timer_pulse_event_handler_t _on_complete;
+    // event handler first argument, pulse generator itself by default
+    void *_owner;
+    // event handler second argument
+    void *_event_arg;
+
+    // -------- public --------
+    // set pulse width, interval of repeated pulses and count of pulses per fire (zero ~ one pulse),
+    // TIMER_PULSE_INVALID_CONFIG if width is zero or repeated pulses interval is not longer than width
+    uint8_t (*set_shape)(Timer_pulse_t *_this, uint16_t width, uint16_t interval, uint16_t pulse_cnt);
+    // leading edge of first pulse delay ticks from now, TIMER_PULSE_DEADLINE_MISSED if delay is too short to arm
+    // the compare in time, TIMER_PULSE_INVALID_CONFIG (also fire_at) if shape is not set
+    uint8_t (*fire)(Timer_pulse_t *_this, uint16_t delay);
+    // leading edge of first pulse delay ticks from reference timestamp, TIMER_PULSE_DEADLINE_MISSED if already passed
+    uint8_t (*fire_at)(Timer_pulse_t *_this, uint16_t reference, uint16_t delay);
+    // stop pulse generation, output is set to idle level immediately
+    uint8_t (*cancel)(Timer_pulse_t *_this);
+    // pulse in progress (including delay), read-only
+    volatile bool active;
+
+};
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Initialize pulse generator on registered handle (not OVERFLOW), output is set to idle level
+ */
+uint8_t timer_pulse_register(Timer_pulse_t *pulse, Timer_channel_handle_t *handle, bool active_low);
+
+
+#endif /* _DRIVER_TIMER_PULSE_H_ */
@@ -0,0 +1,183 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ *  Software PWM - multi-channel PWM on arbitrary IO pins driven by single compare channel
+ *
+ *  Copyright (c) 2018-2019 Mutant Industries ltd.
+ */
+
+#ifndef _DRIVER_TIMER_SOFT_PWM_H_
+#define _DRIVER_TIMER_SOFT_PWM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <driver/disposable.h>
+#include <driver/IO.h>
+#include <driver/timer.h>
+
+// -------------------------------------------------------------------------------------
+
+#define _timer_soft_PWM_(_pwm)                  ((Timer_soft_PWM_t *) (_pwm))
+
+/**
+ * Software PWM public API access
+ */
+#define timer_soft_PWM_start(_pwm)                                                  \
+        (_timer_soft_PWM_(_pwm)->start(_timer_soft_PWM_(_pwm)))
+#define timer_soft_PWM_stop(_pwm)                                                   \
+        (_timer_soft_PWM_(_pwm)->stop(_timer_soft_PWM_(_pwm)))
+#define timer_soft_PWM_set_duty(_pwm, _channel_index, _duty)                        \
+        (_timer_soft_PWM_(_pwm)->set_duty(_timer_soft_PWM_(_pwm), _channel_index, (uint8_t) (_duty)))
+#define timer_soft_PWM_update(_pwm)                                                 \
+        (_timer_soft_PWM_(_pwm)->update(_timer_soft_PWM_(_pwm)))
+#define timer_soft_PWM_is_active(_pwm)                                              \
+        _timer_soft_PWM_(_pwm)->active
+
+/**
+ * Software PWM public API return codes
+ */
+#define TIMER_SOFT_PWM_OK                       TIMER_OK
+#define TIMER_SOFT_PWM_UNSUPPORTED_OPERATION    TIMER_UNSUPPORTED_OPERATION
+#define TIMER_SOFT_PWM_VECTOR_SLOT_UNAVAILABLE  (0x24)
+#define TIMER_SOFT_PWM_ACTIVE                   (0x25)
+#define TIMER_SOFT_PWM_INVALID_CONFIG           (0x27)
+
+/**
+ * Max count of ports driven by single engine
+ */
+#define TIMER_SOFT_PWM_PORT_MAX                 (4)
+
+/**
+ * Required edge schedule length (count of Timer_soft_PWM_edge_t) for given channel count, schedule is double-buffered
+ */
+#define TIMER_SOFT_PWM_SCHEDULE_LENGTH(_channel_cnt) (2 * ((_channel_cnt) + 1))
+
+/**
+ * Address of PxOUT register
+ *  - TIMER_SOFT_PWM_PORT_OUT(PORT_1) -> 8-bit register of port 1
+ *  - TIMER_SOFT_PWM_PORT_OUT(PORT_A) -> 16-bit register of port A (word_access must be set)
+ */
+#define TIMER_SOFT_PWM_PORT_OUT(_port_no)       (PORT_BASE(_port_no) + (OFS_PxOUT))
+
+// -------------------------------------------------------------------------------------
+
+typedef struct Timer_soft_PWM Timer_soft_PWM_t;
+
+/**
+ * Output port
+ */
+typedef struct Timer_soft_PWM_port {
+    // address of PxOUT register {@see TIMER_SOFT_PWM_PORT_OUT}
+    uint16_t OUT_register;
+    // 16-bit register access (PORT_A - PORT_F), 8-bit otherwise
+    bool word_access;
+    // pins driven by engine, other pins of port are not affected
+    uint16_t _pin_mask;
+
+} Timer_soft_PWM_port_t;
+
+/**
+ * Single PWM channel
+ */
+typedef struct Timer_soft_PWM_channel {
+    // index of port in port array
+    uint8_t port_index;
+    // PIN_0 - PIN_15
+    uint16_t pin;
+    // 0 - off, 255 - on, set by set_duty() or directly followed by update()
+    uint8_t duty;
+
+} Timer_soft_PWM_channel_t;
+
+/**
+ * Output change at given time of period
+ */
+typedef struct Timer_soft_PWM_edge {
+    // offset from period start [ticks]
+    uint16_t time;
+    // value of driven pins of each port
+    uint16_t value[TIMER_SOFT_PWM_PORT_MAX];
+
+} Timer_soft_PWM_edge_t;
+
+/**
+ * Software PWM config
+ */
+typedef struct Timer_soft_PWM_config {
+    // PWM period [ticks]
+    uint16_t period;
+    // edges closer than spacing [ticks] are merged, must exceed interrupt latency + service time
+    uint16_t min_edge_spacing;
+    // output ports, up to TIMER_SOFT_PWM_PORT_MAX
+    Timer_soft_PWM_port_t *ports;
+    uint8_t port_cnt;
+    // PWM channels
+    Timer_soft_PWM_channel_t *channels;
+    uint8_t channel_cnt;
+    // edge schedule buffer of TIMER_SOFT_PWM_SCHEDULE_LENGTH(channel_cnt) edges
+    Timer_soft_PWM_edge_t *schedule;
+
+} Timer_soft_PWM_config_t;
+
+/**
+ * Software PWM engine
+ *  - all channels are set at period start and reset at time given by duty, the edges are sorted by time and pins
+ * of the same port changing at the same instant are updated by single 8/16-bit write, so that each compare interrupt
+ * services single edge in bounded time (one read-modify-write per port)
+ *  - edge schedule is recomputed only when duty changes, new schedule is applied from next period start
+ *  - timer must run in MC__CONTINUOUS mode, pin direction and function must be set by application
+ *  - edges closer than min_edge_spacing are merged, so resulting duty resolution is min(8 bits, period / min_edge_spacing)
+ */
+struct Timer_soft_PWM {
+    // enable dispose(Timer_soft_PWM_t *)
+    Disposable_t _disposable;
+    // compare handle, interrupt on each edge
+    Timer_channel_handle_t *_handle;
+    // PWM period [ticks]
+    uint16_t _period;
+    // min distance of two edges [ticks]
+    uint16_t _min_edge_spacing;
+    // output ports
+    Timer_soft_PWM_port_t *_ports;
+    uint8_t _port_cnt;
+    // PWM channels
+    Timer_soft_PWM_channel_t *_channels;
+    uint8_t _channel_cnt;
+    // double-buffered edge schedule
+    Timer_soft_PWM_edge_t *_schedule[2];
+
+    // -------- state --------
+    // count of edges of each schedule
+    uint8_t _edge_cnt[2];
+    // schedule being executed
+    uint8_t _active_index;
+    // edge to be applied on next compare event
+    uint8_t _edge_index;
+    // inactive schedule is ready to be applied from next period start
+    volatile bool _update_pending;
+    // counter at start of current period
+    uint16_t _period_start;
+
+    // -------- public --------
+    // start PWM generation
+    uint8_t (*start)(Timer_soft_PWM_t *_this);
+    // stop PWM generation, reset all driven pins
+    uint8_t (*stop)(Timer_soft_PWM_t *_this);
+    // set duty of single channel, recompute schedule
+    uint8_t (*set_duty)(Timer_soft_PWM_t *_this, uint8_t channel_index, uint8_t duty);
+    // recompute schedule after channels duty changed directly
+    uint8_t (*update)(Timer_soft_PWM_t *_this);
+    // running state
+    bool active;
+
+};
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Initialize software PWM engine on registered compare handle (not OVERFLOW)
+ *  - ports, channels and schedule arrays must stay valid until disposed
+ */
+uint8_t timer_soft_PWM_register(Timer_soft_PWM_t *pwm, Timer_channel_handle_t *handle, Timer_soft_PWM_config_t *config);
+
+
+#endif /* _DRIVER_TIMER_SOFT_PWM_H_ */
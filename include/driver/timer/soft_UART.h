@@ -0,0 +1,161 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ *  Software UART - serial channel on timer capture / compare handles
+ *
+ *  Copyright (c) 2018-2019 Mutant Industries ltd.
+ */
+
+#ifndef _DRIVER_TIMER_SOFT_UART_H_
+#define _DRIVER_TIMER_SOFT_UART_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <driver/disposable.h>
+#include <driver/timer.h>
+
+// -------------------------------------------------------------------------------------
+
+#define _timer_soft_UART_(_uart)                ((Timer_soft_UART_t *) (_uart))
+#define timer_soft_UART_event_handler(_handler) ((timer_soft_UART_event_handler_t) (_handler))
+
+/**
+ * Software UART public API access
+ */
+#define timer_soft_UART_start(_uart)                                                \
+        (_timer_soft_UART_(_uart)->start(_timer_soft_UART_(_uart)))
+#define timer_soft_UART_stop(_uart)                                                 \
+        (_timer_soft_UART_(_uart)->stop(_timer_soft_UART_(_uart)))
+#define timer_soft_UART_write(_uart, _character)                                    \
+        (_timer_soft_UART_(_uart)->write(_timer_soft_UART_(_uart), (uint8_t) (_character)))
+#define timer_soft_UART_read(_uart, _target)                                        \
+        (_timer_soft_UART_(_uart)->read(_timer_soft_UART_(_uart), (uint8_t *) (_target)))
+#define timer_soft_UART_available(_uart)                                            \
+        (_timer_soft_UART_(_uart)->available(_timer_soft_UART_(_uart)))
+#define timer_soft_UART_is_active(_uart)                                            \
+        _timer_soft_UART_(_uart)->active
+
+// getter, setter
+#define timer_soft_UART_on_character_received(_uart) _timer_soft_UART_(_uart)->_on_character_received
+#define timer_soft_UART_on_transmit_buffer_empty(_uart) _timer_soft_UART_(_uart)->_on_transmit_buffer_empty
+#define timer_soft_UART_on_start_bit_received(_uart) _timer_soft_UART_(_uart)->_on_start_bit_received
+#define timer_soft_UART_on_transmit_complete(_uart) _timer_soft_UART_(_uart)->_on_transmit_complete
+#define timer_soft_UART_owner(_uart) _timer_soft_UART_(_uart)->_owner
+#define timer_soft_UART_event_arg(_uart) _timer_soft_UART_(_uart)->_event_arg
+
+/**
+ * Software UART public API return codes
+ */
+#define TIMER_SOFT_UART_OK                          TIMER_OK
+#define TIMER_SOFT_UART_UNSUPPORTED_OPERATION       TIMER_UNSUPPORTED_OPERATION
+#define TIMER_SOFT_UART_VECTOR_SLOT_UNAVAILABLE     (0x24)
+#define TIMER_SOFT_UART_ACTIVE                      (0x25)
+#define TIMER_SOFT_UART_NOT_ACTIVE                  (0x26)
+#define TIMER_SOFT_UART_BUFFER_EMPTY                (0x28)
+#define TIMER_SOFT_UART_BUFFER_FULL                 (0x29)
+
+// -------------------------------------------------------------------------------------
+
+typedef struct Timer_soft_UART Timer_soft_UART_t;
+typedef void (*timer_soft_UART_event_handler_t)(void *owner, void *event_arg);
+
+/**
+ * Software UART config, 8 data bits, no parity, one stop bit, LSB first
+ */
+typedef struct Timer_soft_UART_config {
+    // frequency of timer counter [Hz], should be at least 16 times the baudrate
+    uint32_t timer_frequency;
+    // baudrate [bit/s]
+    uint32_t baudrate;
+    // receive ring buffer
+    uint8_t *RX_buffer;
+    uint16_t RX_buffer_length;
+    // transmit ring buffer
+    uint8_t *TX_buffer;
+    uint16_t TX_buffer_length;
+
+} Timer_soft_UART_config_t;
+
+/**
+ * Single serial channel on up to two handles of timer in MC__CONTINUOUS mode
+ *  - RX handle - start bit edge is captured (CM__FALLING on CCIxA), then handle is switched to compare mode and each bit
+ * is sampled by hardware (SCCI latched on compare event) in the middle of bit time
+ *  - TX handle - each bit level is set by hardware on compare event (OUTMOD_1 / OUTMOD_5), so the bit timing is exact
+ * regardless of interrupt latency, interrupt latency must be below one bit time
+ *  - CPU cost is one interrupt per bit per direction, several channels can share one timer
+ *  - port pin function of RX (CCIxA input) and TX (timer output) must be set by application
+ *  - event handlers are executed from interrupt, surface corresponds to UART_driver_t
+ */
+struct Timer_soft_UART {
+    // enable dispose(Timer_soft_UART_t *)
+    Disposable_t _disposable;
+    // receive handle, optional
+    Timer_channel_handle_t *_RX_handle;
+    // transmit handle, optional
+    Timer_channel_handle_t *_TX_handle;
+    // bit time [ticks]
+    uint16_t _bit_time;
+    // ring buffers
+    uint8_t *_RX_buffer;
+    uint16_t _RX_buffer_length;
+    uint8_t *_TX_buffer;
+    uint16_t _TX_buffer_length;
+
+    // -------- state --------
+    // receive ring buffer indexes
+    volatile uint16_t _RX_head;
+    volatile uint16_t _RX_tail;
+    // transmit ring buffer indexes
+    volatile uint16_t _TX_head;
+    volatile uint16_t _TX_tail;
+    // bits received in current character
+    uint8_t _RX_bit_cnt;
+    // received bits
+    uint8_t _RX_shift;
+    // bits of current character not scheduled yet
+    uint8_t _TX_bit_cnt;
+    // remaining bits of current character (data, stop bit)
+    uint16_t _TX_shift;
+    // transmission in progress
+    volatile bool _TX_active;
+    // interrupt service handlers
+    timer_soft_UART_event_handler_t _on_character_received;
+    timer_soft_UART_event_handler_t _on_transmit_buffer_empty;
+    timer_soft_UART_event_handler_t _on_start_bit_received;
+    timer_soft_UART_event_handler_t _on_transmit_complete;
+    // event handler first argument, channel itself by default
+    void *_owner;
+    // event handler second argument
+    void *_event_arg;
+
+    // -------- public --------
+    // start receiver, set transmit line idle
+    uint8_t (*start)(Timer_soft_UART_t *_this);
+    // stop receiver and transmitter, pending characters are dropped
+    uint8_t (*stop)(Timer_soft_UART_t *_this);
+    // queue character for transmission
+    uint8_t (*write)(Timer_soft_UART_t *_this, uint8_t character);
+    // read received character
+    uint8_t (*read)(Timer_soft_UART_t *_this, uint8_t *target);
+    // count of received characters
+    uint16_t (*available)(Timer_soft_UART_t *_this);
+    // count of characters with missing stop bit, read-only
+    uint16_t framing_error_cnt;
+    // count of received characters dropped due to full receive buffer, read-only
+    uint16_t overrun_cnt;
+    // running state
+    bool active;
+
+};
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Initialize software UART channel
+ *  - RX and TX handles (not OVERFLOW) must be registered on the same timer, either one may be NULL
+ *  - ring buffers must stay valid until disposed
+ */
+uint8_t timer_soft_UART_register(Timer_soft_UART_t *uart, Timer_channel_handle_t *RX_handle, Timer_channel_handle_t *TX_handle,
+        Timer_soft_UART_config_t *config);
+
+
+#endif /* _DRIVER_TIMER_SOFT_UART_H_ */
@@ -0,0 +1,140 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ *  DMA-fed timer waveform generator - stream of compare values transferred to CCRn register on each timer period
+ *
+ *  Copyright (c) 2018-2019 Mutant Industries ltd.
+ */
+
+#ifndef _DRIVER_TIMER_WAVEFORM_H_
+#define _DRIVER_TIMER_WAVEFORM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <driver/DMA.h>
+#include <driver/disposable.h>
+#include <driver/timer.h>
+
+// -------------------------------------------------------------------------------------
+
+#define _timer_waveform_(_waveform)             ((Timer_waveform_t *) (_waveform))
+#define timer_waveform_event_handler(_handler)  ((timer_waveform_event_handler_t) (_handler))
+
+/**
+ * Timer waveform public API access
+ */
+#define timer_waveform_start(_waveform, _mode, _buffer, _length)                    \
+        (_timer_waveform_(_waveform)->start(_timer_waveform_(_waveform), _mode, (uint16_t *) (_buffer), _length))
+#define timer_waveform_stop(_waveform)                                              \
+        (_timer_waveform_(_waveform)->stop(_timer_waveform_(_waveform)))
+#define timer_waveform_queue(_waveform, _buffer)                                    \
+        (_timer_waveform_(_waveform)->queue(_timer_waveform_(_waveform), (uint16_t *) (_buffer)))
+#define timer_waveform_is_active(_waveform)                                         \
+        _timer_waveform_(_waveform)->active
+
+// getter, setter
+#define timer_waveform_on_buffer_released(_waveform) _timer_waveform_(_waveform)->_on_buffer_released
+#define timer_waveform_owner(_waveform) _timer_waveform_(_waveform)->_owner
+
+/**
+ * Timer waveform public API return codes
+ */
+#define TIMER_WAVEFORM_OK                       TIMER_OK
+#define TIMER_WAVEFORM_UNSUPPORTED_OPERATION    TIMER_UNSUPPORTED_OPERATION
+#define TIMER_WAVEFORM_VECTOR_SLOT_UNAVAILABLE  (0x24)
+#define TIMER_WAVEFORM_ACTIVE                   (0x25)
+#define TIMER_WAVEFORM_NOT_ACTIVE               (0x26)
+#define TIMER_WAVEFORM_INVALID_MODE             (0x27)
+
+// -------------------------------------------------------------------------------------
+
+typedef struct Timer_waveform Timer_waveform_t;
+
+/**
+ * Buffer released event handler
+ *  - owner - waveform owner, waveform itself by default
+ *  - buffer - buffer that has been fully transferred and that may be refilled / queued again
+ */
+typedef void (*timer_waveform_event_handler_t)(void *owner, uint16_t *buffer);
+
+typedef enum {
+    /**
+     * Buffer is transferred once, output channel keeps the last compare value
+     *  - buffer released event is triggered after the last value is transferred
+     */
+    WAVEFORM_ONE_SHOT = 1,
+    /**
+     * Buffer is transferred repeatedly until stopped
+     *  - no interrupts are involved
+     */
+    WAVEFORM_LOOP = 2,
+    /**
+     * Two (or more) buffers are transferred alternately, next buffer is set by queue()
+     *  - buffer released event is triggered each time a transfer of buffer is completed and transfer of next queued buffer
+     * has already begun, the released buffer can be refilled and queued again
+     *  - queued buffer is set as DMA source in transfer complete interrupt, so it is transferred after the block that
+     * follows the interrupt (buffer queued from buffer released event follows the current one)
+     *  - if no buffer is queued in time, then the current buffer is transferred again
+     */
+    WAVEFORM_DOUBLE_BUFFERED = 3
+
+} Timer_waveform_mode;
+
+/**
+ * DMA-fed timer waveform generator
+ *  - on each DMA trigger (typically CCR0 compare event of timer in MC__UP mode, which defines the waveform period)
+ * one 16-bit value from buffer is transferred to CCRn register of output channel
+ *  - both trigger and output channel handles are switched to compare mode with interrupts disabled on start
+ */
+struct Timer_waveform {
+    // enable dispose(Timer_waveform_t *)
+    Disposable_t _disposable;
+    // handle the compare event of which triggers DMA transfer
+    Timer_channel_handle_t *_trigger_handle;
+    // handle the CCRn register of which is DMA transfer destination
+    Timer_channel_handle_t *_output_handle;
+    // DMA channel that transfers compare values
+    DMA_channel_handle_t *_DMA_channel;
+    // DMA trigger corresponding to trigger handle (DMA0TSEL__TA0CCR0, DMA0TSEL__TA1CCR0...)
+    uint16_t _DMA_trigger;
+    // output channel output mode (OUTMOD_0 - OUTMOD_7)
+    uint16_t _output_mode;
+
+    // -------- state --------
+    // current transfer mode
+    Timer_waveform_mode _mode;
+    // buffer being transferred
+    uint16_t *_buffer;
+    // buffer set as DMA source, loaded on next block repeat in double-buffered mode
+    uint16_t *_buffer_next;
+    // buffer queued for transfer in double-buffered mode, set as DMA source on next transfer complete interrupt
+    uint16_t *_buffer_queued;
+    // buffer released event handler
+    timer_waveform_event_handler_t _on_buffer_released;
+    // event handler first argument, waveform itself by default
+    void *_owner;
+
+    // -------- public --------
+    // start transfer of given buffer of given length (count of compare values) in given mode
+    uint8_t (*start)(Timer_waveform_t *_this, Timer_waveform_mode mode, uint16_t *buffer, uint16_t length);
+    // stop DMA transfer and both trigger and output channel
+    uint8_t (*stop)(Timer_waveform_t *_this);
+    // set next buffer (of the same length) to be transferred in double-buffered mode
+    uint8_t (*queue)(Timer_waveform_t *_this, uint16_t *buffer);
+    // transfer in progress state
+    bool active;
+
+};
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Initialize waveform generator
+ *  - trigger handle, output handle and DMA channel must be registered already, trigger handle may be the same as output handle
+ *  - DMA interrupt handler is registered on given DMA channel, therefore one vector slot is required (shared with
+ * all other DMA channels)
+ */
+uint8_t timer_waveform_register(Timer_waveform_t *waveform, Timer_channel_handle_t *trigger_handle, Timer_channel_handle_t *output_handle,
+        DMA_channel_handle_t *DMA_channel, uint16_t DMA_trigger, uint16_t output_mode);
+
+
+#endif /* _DRIVER_TIMER_WAVEFORM_H_ */
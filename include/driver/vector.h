@@ -34,6 +34,8 @@
             (_vector_handle_(_handle)->register_handler(_vector_handle_(_handle), _vector_slot_handler_(_handler), _arg_1, _arg_2))
 #define vector_disable_slot_release_on_dispose(_handle)             \
             (_vector_handle_(_handle)->disable_slot_release_on_dispose(_vector_handle_(_handle)))
+#define vector_release_handler(_handle)                             \
+            __vector_release_handler(_vector_handle_(_handle))
 
 /**
  * Vector handle public API return codes
@@ -176,5 +178,11 @@ struct Vector_handle {
 void vector_handle_register(Vector_handle_t *handle, dispose_function_t dispose_hook,
         uint8_t vector_no, uint16_t IE_register, uint16_t IE_mask, uint16_t IFG_register, uint16_t IFG_mask);
 
+/**
+ * Undo register_handler() without disposing the handle - interrupt is disabled, handler of shared vector handle is
+ * cleared, own slot is released and original vector content restored, handler can be registered again afterwards
+ */
+void __vector_release_handler(Vector_handle_t *handle);
+
 
 #endif /* _DRIVER_VECTOR_H_ */
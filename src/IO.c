@@ -12,17 +12,88 @@
 // array of pointers to registered drivers, persistent to allow wakeup on FRAM devices
 __persistent IO_port_driver_t *registered_drivers[MAX_PORT_COUNT] = {0};
 
+#ifndef __IO_PORT_LEGACY_SUPPORT__
+/**
+ * Port state snapshot taken by IO_low_power_mode_prepare(), restored by IO_wakeup_reinit()
+ */
+typedef struct IO_port_image {
+    // wakeup-enabled driver
+    IO_port_driver_t *driver;
+    // first handle with registered interrupt handler, port vector slot is registered on it
+    IO_pin_handle_t *slot_handle;
+    // register images
+    uint8_t OUT_image;
+    uint8_t DIR_image;
+    uint8_t REN_image;
+    uint8_t SEL0_image;
+#ifdef OFS_PxSEL1
+    uint8_t SEL1_image;
+#endif
+    uint8_t IES_image;
+    uint8_t IE_image;
+
+} IO_port_image_t;
+
+// port images in registered_drivers order, persistent to allow wakeup on FRAM devices
+__persistent IO_port_image_t port_images[MAX_PORT_COUNT] = {0};
+// count of valid port images, zero if low-power mode has not been prepared
+__persistent uint8_t port_image_cnt = 0;
+#endif
+
+// source of last wakeup
+IO_wakeup_source_t IO_wakeup_source = {0};
+
 static uint8_t _unsupported_operation() {
     return IO_UNSUPPORTED_OPERATION;
 }
 
 // -------------------------------------------------------------------------------------
 
+#ifdef __IO_PORT_COALESCED_DISPATCH__
+
+static void _shared_vector_handler(IO_port_driver_t *driver) {
+    uint8_t pending, handle_pending, pin;
+    IO_pin_handle_t *handle, **handle_ref;
+
+    if (driver->_timestamp_register) {
+        driver->timestamp = hw_register_16(driver->_timestamp_register);
+    }
+
+    pending = IO_driver_reg(driver, IFG) & IO_driver_reg(driver, IE);
+
+    // clear all serviced flags at once, edges from now on trigger next interrupt
+    IO_driver_reg_reset(driver, IFG, pending);
+
+    for (pin = 1, handle_ref = &driver->_pin0_handle; pending; pin <<= 1, handle_ref++) {
+        if ( ! (pending & pin)) {
+            continue;
+        }
+
+        if ((handle = *handle_ref) == NULL) {
+            pending &= ~pin;
+
+            continue;
+        }
+
+        // each handle is executed once with union of its pending pins
+        handle_pending = pending & handle->_pin_mask;
+        pending &= ~handle_pending;
+
+        handle->_handler(handle->_handler_arg, (void *) (uint16_t) handle_pending);
+    }
+}
+
+#else
+
 static void _shared_vector_handler(IO_port_driver_t *driver) {
     uint8_t interrupt_pin_no;
     uint16_t interrupt_source;
     IO_pin_handle_t *handle;
 
+    if (driver->_timestamp_register) {
+        driver->timestamp = hw_register_16(driver->_timestamp_register);
+    }
+
     if ( ! (interrupt_source = hw_register_16(driver->_IV_register))) {
         return;
     }
@@ -36,6 +107,8 @@ static void _shared_vector_handler(IO_port_driver_t *driver) {
     handle->_handler(handle->_handler_arg, (void *) (((uint16_t) 0x0001) << interrupt_pin_no));
 }
 
+#endif /* __IO_PORT_COALESCED_DISPATCH__ */
+
 static Vector_slot_t *_register_handler_shared(IO_pin_handle_t *_this, vector_slot_handler_t handler, void *arg) {
 
     interrupt_suspend();
@@ -228,12 +301,94 @@ void IO_port_driver_register(IO_port_driver_t *driver, uint8_t port_no, uint16_t
 
 // -------------------------------------------------------------------------------------
 
+#ifndef __IO_PORT_LEGACY_SUPPORT__
+
+/**
+ * Register port vector slot on given handle again, original slot has been released before low-power mode
+ */
+static void _slot_reinit(IO_port_driver_t *port, IO_pin_handle_t *handle) {
+    // reset reference to already released slot
+    handle->vector._slot = NULL;
+    // reinit (non-persistent) port vector slot
+    port->_slot = handle->_register_handler_parent(&handle->vector,
+            (vector_slot_handler_t) _shared_vector_handler, port, NULL);
+}
+
+/**
+ * Record first port (in port number order) with pending enabled interrupt
+ */
+static void _wakeup_source_check(IO_port_driver_t *port, uint8_t interrupt_enable_mask) {
+    uint8_t pin_mask;
+
+    if ( ! IO_wakeup_source.port_no && (pin_mask = IO_driver_reg(port, IFG) & interrupt_enable_mask)) {
+        IO_wakeup_source.port_no = port->_port_no;
+        IO_wakeup_source.pin_mask = pin_mask;
+    }
+}
+
+/**
+ * Restore port state from images taken by IO_low_power_mode_prepare(), no port_init is executed
+ */
+static void _wakeup_restore() {
+    IO_port_image_t *image;
+    IO_port_driver_t *port;
+    uint8_t image_index;
+
+    // port registers without interrupt enable
+    for (image_index = 0, image = port_images; image_index < port_image_cnt; image_index++, image++) {
+        port = image->driver;
+
+        IO_driver_reg(port, OUT) = image->OUT_image;
+        IO_driver_reg(port, DIR) = image->DIR_image;
+        IO_driver_reg(port, REN) = image->REN_image;
+        IO_driver_reg(port, SEL0) = image->SEL0_image;
+#ifdef OFS_PxSEL1
+        IO_driver_reg(port, SEL1) = image->SEL1_image;
+#endif
+        IO_driver_reg(port, IES) = image->IES_image;
+    }
+
+    IO_unlock();
+
+    // disable interrupts so that handler with highest priority shall be triggered first
+    interrupt_suspend();
+
+    for (image_index = 0, image = port_images; image_index < port_image_cnt; image_index++, image++) {
+        port = image->driver;
+
+        if (image->slot_handle) {
+            _slot_reinit(port, image->slot_handle);
+        }
+
+        _wakeup_source_check(port, image->IE_image);
+
+        IO_driver_reg(port, IE) = image->IE_image;
+    }
+
+    // images are valid for single wakeup
+    port_image_cnt = 0;
+
+    interrupt_restore();
+}
+
+#endif /* __IO_PORT_LEGACY_SUPPORT__ */
+
 void IO_wakeup_reinit() {
 
 #ifndef __IO_PORT_LEGACY_SUPPORT__
     IO_port_driver_t *port, **port_ref;
     IO_pin_handle_t *handle, **handle_ref;
-    uint8_t port_index, handle_index;
+    uint8_t port_index, handle_index, interrupt_enable_mask;
+
+    IO_wakeup_source.port_no = 0;
+    IO_wakeup_source.pin_mask = 0;
+
+    // snapshot taken on low-power mode prepare
+    if (port_image_cnt) {
+        _wakeup_restore();
+
+        return;
+    }
 
     // initialize port registers exactly the same way as they were configured before the device entered LPMx.5
     for (port_index = 0, port_ref = registered_drivers; port_index < MAX_PORT_COUNT; port_index++, port_ref++) {
@@ -254,11 +409,7 @@ void IO_wakeup_reinit() {
         for (handle_index = 0, handle_ref = &port->_pin0_handle; handle_index < 8; handle_index++, handle_ref++) {
             // search for first handle with registered interrupt handler
             if ((handle = *handle_ref) != NULL && handle->_handler) {
-                // reset reference to already released slot
-                handle->vector._slot = NULL;
-                // reinit (non-persistent) port vector slot
-                port->_slot = handle->_register_handler_parent(&handle->vector,
-                        (vector_slot_handler_t) _shared_vector_handler, port, NULL);
+                _slot_reinit(port, handle);
 
                 // slot is registered just once per port
                 break;
@@ -279,9 +430,19 @@ void IO_wakeup_reinit() {
             continue;
         }
 
+        interrupt_enable_mask = 0;
+
         // search for first handle with registered interrupt handler
         for (handle_index = 0, handle_ref = &port->_pin0_handle; handle_index < 8; handle_index++, handle_ref++) {
             // set corresponding interrupt enable bits if vector interrupts were enabled
+            if ((handle = *handle_ref) != NULL && handle->vector.enabled) {
+                interrupt_enable_mask |= handle->_pin_mask;
+            }
+        }
+
+        _wakeup_source_check(port, interrupt_enable_mask);
+
+        for (handle_index = 0, handle_ref = &port->_pin0_handle; handle_index < 8; handle_index++, handle_ref++) {
             if ((handle = *handle_ref) != NULL && handle->vector.enabled) {
                 vector_set_enabled(&handle->vector, true);
             }
@@ -295,6 +456,13 @@ void IO_wakeup_reinit() {
 void IO_low_power_mode_prepare() {
     IO_port_driver_t *port, **port_ref;
     uint8_t port_index, pin_function_reset_mask;
+#ifndef __IO_PORT_LEGACY_SUPPORT__
+    IO_port_image_t *image = port_images;
+    IO_pin_handle_t **handle_ref;
+    uint8_t handle_index;
+
+    port_image_cnt = 0;
+#endif
 
     // prepare all registered port drivers for low-power mode
     for (port_index = 0, port_ref = registered_drivers; port_index < MAX_PORT_COUNT; port_index++, port_ref++) {
@@ -302,6 +470,35 @@ void IO_low_power_mode_prepare() {
             continue;
         }
 
+#ifndef __IO_PORT_LEGACY_SUPPORT__
+        // snapshot of wakeup-enabled port before pin functions are reset
+        if (port->_port_init) {
+            image->driver = port;
+            image->slot_handle = NULL;
+            image->OUT_image = IO_driver_reg(port, OUT);
+            image->DIR_image = IO_driver_reg(port, DIR);
+            image->REN_image = IO_driver_reg(port, REN);
+            image->SEL0_image = IO_driver_reg(port, SEL0);
+#ifdef OFS_PxSEL1
+            image->SEL1_image = IO_driver_reg(port, SEL1);
+#endif
+            image->IES_image = IO_driver_reg(port, IES);
+            image->IE_image = IO_driver_reg(port, IE);
+
+            // slot is registered just once per port
+            for (handle_index = 0, handle_ref = &port->_pin0_handle; port->_slot && handle_index < 8; handle_index++, handle_ref++) {
+                if (*handle_ref != NULL && (*handle_ref)->_handler) {
+                    image->slot_handle = *handle_ref;
+
+                    break;
+                }
+            }
+
+            image++;
+            port_image_cnt++;
+        }
+#endif
+
         // restore original vector content (otherwise it would be lost)
         if (port->_slot) {
             dispose(port->_slot);
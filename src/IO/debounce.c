@@ -0,0 +1,217 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2018-2019 Mutant Industries ltd.
+#include <driver/IO/debounce.h>
+#include <stddef.h>
+#include <driver/interrupt.h>
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _unsupported_operation() {
+    return IO_DEBOUNCE_UNSUPPORTED_OPERATION;
+}
+
+/**
+ * Edge select opposite to debounced level (PxIES set ~ falling edge), clear flags of pins that changed on edge select
+ * change, enable edge interrupt unless input changed meanwhile
+ */
+static bool _edge_arm(IO_debounce_input_t *_this) {
+    IO_pin_handle_t *handle = _this->_handle;
+
+    IO_pin_handle_reg(handle, IES) = (IO_pin_handle_reg(handle, IES) & ~handle->_pin_mask) | _this->state;
+    IO_pin_handle_reg_reset(handle, IFG);
+
+    // level changed before edge select was set
+    if ((IO_pin_handle_reg(handle, IN) & handle->_pin_mask) != _this->state) {
+        return false;
+    }
+
+    vector_set_enabled(handle, true);
+
+    return true;
+}
+
+/**
+ * Start periodic sampling of input, start timer handle if not started yet
+ */
+static void _sampling_start(IO_debounce_input_t *_this) {
+    IO_debounce_t *engine = _this->_engine;
+    uint16_t counter;
+
+    _this->_counter_0 = _this->_counter_1 = 0xFF;
+    _this->_stable_cnt = 0;
+    _this->_sampling = true;
+
+    if (engine->_sampling_cnt++) {
+        return;
+    }
+
+    timer_channel_set_compare_mode(engine->_handle, OUTMOD_0);
+    timer_channel_start(engine->_handle);
+    timer_channel_get_counter(engine->_handle, &counter);
+    hw_register_16(engine->_handle->_CCRn_register) = counter + engine->_sample_period;
+    vector_clear_interrupt_flag(engine->_handle);
+
+    engine->active = true;
+}
+
+/**
+ * One sample of input, vertical counter is reset on each sample equal to debounced level
+ */
+static void _sample(IO_debounce_input_t *_this) {
+    uint8_t delta, changed;
+
+    delta = (IO_pin_handle_reg(_this->_handle, IN) & _this->_handle->_pin_mask) ^ _this->state;
+
+    _this->_counter_0 = ~(_this->_counter_0 & delta);
+    _this->_counter_1 = _this->_counter_0 ^ (_this->_counter_1 & delta);
+
+    // counter rolled over - level differed in IO_DEBOUNCE_SAMPLE_CNT consecutive samples
+    if ((changed = delta & _this->_counter_0 & _this->_counter_1)) {
+        _this->state ^= changed;
+        _this->_stable_cnt = 0;
+
+        if (_this->_on_change) {
+            _this->_on_change(_this->_owner, changed, _this->state);
+        }
+
+        return;
+    }
+
+    if (delta) {
+        _this->_stable_cnt = 0;
+    }
+    else if (++_this->_stable_cnt >= IO_DEBOUNCE_SAMPLE_CNT && _edge_arm(_this)) {
+        _this->_sampling = false;
+        _this->_engine->_sampling_cnt--;
+    }
+}
+
+// -------------------------------------------------------------------------------------
+
+static void _edge_handler(IO_debounce_input_t *_this) {
+
+    // no more edge interrupts until stable
+    vector_set_enabled(_this->_handle, false);
+
+    if ( ! _this->_sampling) {
+        _sampling_start(_this);
+    }
+}
+
+static void _sample_handler(IO_debounce_t *_this) {
+    IO_debounce_input_t *input;
+
+    hw_register_16(_this->_handle->_CCRn_register) += _this->_sample_period;
+
+    for (input = _this->_inputs; input; input = input->_next) {
+        if (input->_sampling) {
+            _sample(input);
+        }
+    }
+
+    if ( ! _this->_sampling_cnt) {
+        timer_channel_stop(_this->_handle);
+        _this->active = false;
+    }
+}
+
+// -------------------------------------------------------------------------------------
+
+// IO_debounce_input_t destructor
+static dispose_function_t _IO_debounce_input_dispose(IO_debounce_input_t *_this) {
+    IO_debounce_input_t **input_ref;
+
+    interrupt_suspend();
+
+    vector_set_enabled(_this->_handle, false);
+
+    if (_this->_sampling) {
+        _this->_sampling = false;
+        _this->_engine->_sampling_cnt--;
+    }
+
+    for (input_ref = &_this->_engine->_inputs; *input_ref; input_ref = &(*input_ref)->_next) {
+        if (*input_ref == _this) {
+            *input_ref = _this->_next;
+
+            break;
+        }
+    }
+
+    interrupt_restore();
+
+    _this->_on_change = NULL;
+
+    // debounced state can still be read after disposed
+
+    return NULL;
+}
+
+// IO_debounce_input_t constructor
+uint8_t IO_debounce_input_register(IO_debounce_input_t *input, IO_debounce_t *debounce, IO_pin_handle_t *handle) {
+
+    zerofill(input);
+
+    // private
+    input->_engine = debounce;
+    input->_handle = handle;
+    input->_owner = input;
+
+    if ( ! vector_register_handler(handle, _edge_handler, input, NULL)) {
+        return IO_DEBOUNCE_VECTOR_SLOT_UNAVAILABLE;
+    }
+
+    vector_set_enabled(handle, false);
+
+    // public
+    input->state = IO_pin_handle_reg(handle, IN) & handle->_pin_mask;
+
+    interrupt_suspend();
+
+    input->_next = debounce->_inputs;
+    debounce->_inputs = input;
+
+    if ( ! _edge_arm(input)) {
+        _sampling_start(input);
+    }
+
+    interrupt_restore();
+
+    __dispose_hook_register(input, _IO_debounce_input_dispose);
+
+    return IO_DEBOUNCE_OK;
+}
+
+// -------------------------------------------------------------------------------------
+
+// IO_debounce_t destructor
+static dispose_function_t _IO_debounce_dispose(IO_debounce_t *_this) {
+
+    while (_this->_inputs) {
+        dispose(_this->_inputs);
+    }
+
+    timer_channel_stop(_this->_handle);
+
+    _this->active = false;
+
+    return NULL;
+}
+
+// IO_debounce_t constructor
+uint8_t IO_debounce_register(IO_debounce_t *debounce, Timer_channel_handle_t *handle, uint16_t sample_period) {
+
+    zerofill(debounce);
+
+    // private
+    debounce->_handle = handle;
+    debounce->_sample_period = sample_period;
+
+    if ( ! vector_register_handler(handle, _sample_handler, debounce, NULL)) {
+        return IO_DEBOUNCE_VECTOR_SLOT_UNAVAILABLE;
+    }
+
+    __dispose_hook_register(debounce, _IO_debounce_dispose);
+
+    return IO_DEBOUNCE_OK;
+}
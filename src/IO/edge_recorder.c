@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2018-2019 Mutant Industries ltd.
+#include <driver/IO/edge_recorder.h>
+#include <stddef.h>
+#include <driver/interrupt.h>
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _unsupported_operation() {
+    return IO_EDGE_RECORDER_UNSUPPORTED_OPERATION;
+}
+
+static void _record_push(IO_edge_recorder_t *_this, uint8_t pin, uint8_t level, uint16_t timestamp) {
+    IO_edge_record_t *record;
+    uint16_t head = _this->_head + 1;
+
+    if (head == _this->_length) {
+        head = 0;
+    }
+
+    if (head == _this->_tail) {
+        _this->overrun_cnt++;
+
+        return;
+    }
+
+    record = &_this->_buffer[_this->_head];
+    record->timestamp = timestamp;
+    record->pin = pin;
+    record->level = level;
+
+    _this->_head = head;
+}
+
+/**
+ * Set edge select of pin opposite to current level, return level the edge select corresponds to
+ */
+static uint8_t _edge_select_flip(IO_edge_recorder_t *_this, uint8_t pin) {
+    uint8_t level;
+
+    do {
+        level = IO_pin_handle_reg(_this->_handle, IN) & pin;
+
+        // high ~ falling edge next
+        if (level) {
+            IO_pin_handle_reg(_this->_handle, IES) |= pin;
+        }
+        else {
+            IO_pin_handle_reg(_this->_handle, IES) &= ~pin;
+        }
+
+        // flag possibly set by edge select change
+        IO_pin_handle_reg(_this->_handle, IFG) &= ~pin;
+
+    // level changed meanwhile, flag might have been cleared
+    } while ((IO_pin_handle_reg(_this->_handle, IN) & pin) != level);
+
+    return level ? 1 : 0;
+}
+
+// -------------------------------------------------------------------------------------
+
+static void _edge_handler(IO_edge_recorder_t *_this, uint16_t pin_mask) {
+    uint16_t timestamp = IO_port_timestamp(_this->_handle->_driver);
+    uint8_t pin, edge_level, level;
+
+    // single pin or union of pending pins of handle (coalesced dispatch)
+    for (pin = 1; pin; pin <<= 1) {
+        if ( ! (pin_mask & pin)) {
+            continue;
+        }
+
+        // level after edge is given by edge select the interrupt was triggered by
+        edge_level = IO_pin_handle_reg(_this->_handle, IES) & pin ? 0 : 1;
+
+        _record_push(_this, pin, edge_level, timestamp);
+
+        if ( ! _this->_both_edges) {
+            continue;
+        }
+
+        // edge missed before edge select is flipped
+        if ((level = _edge_select_flip(_this, pin)) != edge_level) {
+            _record_push(_this, pin, level, timestamp);
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _start(IO_edge_recorder_t *_this) {
+    uint8_t pin;
+
+    if (_this->active) {
+        return IO_EDGE_RECORDER_ACTIVE;
+    }
+
+    _this->_head = _this->_tail = 0;
+
+    interrupt_suspend();
+
+    if (_this->_both_edges) {
+        for (pin = 1; pin; pin <<= 1) {
+            if (_this->_handle->_pin_mask & pin) {
+                _edge_select_flip(_this, pin);
+            }
+        }
+    }
+    else {
+        vector_clear_interrupt_flag(_this->_handle);
+    }
+
+    vector_set_enabled(_this->_handle, true);
+
+    _this->active = true;
+
+    interrupt_restore();
+
+    return IO_EDGE_RECORDER_OK;
+}
+
+static uint8_t _stop(IO_edge_recorder_t *_this) {
+
+    vector_set_enabled(_this->_handle, false);
+
+    _this->active = false;
+
+    return IO_EDGE_RECORDER_OK;
+}
+
+static uint8_t _read(IO_edge_recorder_t *_this, IO_edge_record_t *target) {
+    uint16_t tail = _this->_tail;
+
+    if (tail == _this->_head) {
+        return IO_EDGE_RECORDER_EMPTY;
+    }
+
+    *target = _this->_buffer[tail];
+
+    if (++tail == _this->_length) {
+        tail = 0;
+    }
+
+    _this->_tail = tail;
+
+    return IO_EDGE_RECORDER_OK;
+}
+
+static uint16_t _available(IO_edge_recorder_t *_this) {
+    uint16_t head = _this->_head;
+
+    return head >= _this->_tail ? head - _this->_tail : _this->_length - _this->_tail + head;
+}
+
+// -------------------------------------------------------------------------------------
+
+// IO_edge_recorder_t destructor
+static dispose_function_t _IO_edge_recorder_dispose(IO_edge_recorder_t *_this) {
+
+    _this->stop(_this);
+
+    _this->start = (uint8_t (*)(IO_edge_recorder_t *)) _unsupported_operation;
+    _this->stop = (uint8_t (*)(IO_edge_recorder_t *)) _unsupported_operation;
+
+    // recorded edges can still be read after disposed
+
+    return NULL;
+}
+
+// IO_edge_recorder_t constructor
+uint8_t IO_edge_recorder_register(IO_edge_recorder_t *recorder, IO_pin_handle_t *handle, IO_edge_record_t *buffer, uint16_t length,
+        bool both_edges) {
+
+    zerofill(recorder);
+
+    // private
+    recorder->_handle = handle;
+    recorder->_buffer = buffer;
+    recorder->_length = length;
+    recorder->_both_edges = both_edges;
+
+    if ( ! vector_register_handler(handle, _edge_handler, recorder, NULL)) {
+        return IO_EDGE_RECORDER_VECTOR_SLOT_UNAVAILABLE;
+    }
+
+    vector_set_enabled(handle, false);
+
+    // public
+    recorder->start = _start;
+    recorder->stop = _stop;
+    recorder->read = _read;
+    recorder->available = _available;
+
+    __dispose_hook_register(recorder, _IO_edge_recorder_dispose);
+
+    return IO_EDGE_RECORDER_OK;
+}
@@ -0,0 +1,279 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2018-2019 Mutant Industries ltd.
+#include <driver/IO/keypad.h>
+#include <stddef.h>
+#include <driver/interrupt.h>
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _unsupported_operation() {
+    return IO_KEYPAD_UNSUPPORTED_OPERATION;
+}
+
+/**
+ * Drive given row low, set other rows to high impedance, skip pins not in row handle
+ */
+static bool _row_select(IO_keypad_t *_this, uint8_t row) {
+    IO_pin_handle_t *handle = _this->_row_handle;
+
+    for ( ; row < 8; row++) {
+        if (handle->_pin_mask & (1 << row)) {
+            IO_pin_handle_reg_reset(handle, DIR);
+            IO_pin_handle_reg(handle, DIR) |= (1 << row);
+
+            _this->_row = row;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Drive all rows low, falling edge select on columns, clear flags, enable column interrupt unless key pressed meanwhile
+ */
+static bool _idle_arm(IO_keypad_t *_this) {
+    IO_pin_handle_t *column = _this->_column_handle;
+
+    IO_pin_handle_reg_set(_this->_row_handle, DIR);
+    IO_pin_handle_reg_set(column, IES);
+    IO_pin_handle_reg_reset(column, IFG);
+
+    // key pressed before edge select was set
+    if ((IO_pin_handle_reg(column, IN) & column->_pin_mask) != column->_pin_mask) {
+        return false;
+    }
+
+    vector_set_enabled(column, true);
+
+    return true;
+}
+
+static void _scan_start(IO_keypad_t *_this) {
+    uint16_t counter;
+
+    _this->_stable_cnt = 0;
+    _this->_scan_changed = false;
+    _this->scanning = true;
+
+    _row_select(_this, 0);
+
+    timer_channel_set_compare_mode(_this->_handle, OUTMOD_0);
+    timer_channel_start(_this->_handle);
+    timer_channel_get_counter(_this->_handle, &counter);
+    hw_register_16(_this->_handle->_CCRn_register) = counter + _this->_row_period;
+    vector_clear_interrupt_flag(_this->_handle);
+}
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Two rows sharing two or more pressed columns - without diodes any key of such rectangle might be a ghost
+ */
+static bool _ghosting(IO_keypad_t *_this) {
+    uint8_t row, other, common;
+
+    for (row = 0; row < 7; row++) {
+        if ( ! _this->_raw[row]) {
+            continue;
+        }
+
+        for (other = row + 1; other < 8; other++) {
+            common = _this->_raw[row] & _this->_raw[other];
+
+            if (common & (common - 1)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Accept debounced scan, report changed keys
+ */
+static void _state_accept(IO_keypad_t *_this) {
+    uint8_t row, column, changed, key_cnt = 0;
+
+    if ( ! _this->_diodes && _ghosting(_this)) {
+        _this->ghosting = true;
+
+        return;
+    }
+
+    _this->ghosting = false;
+
+    for (row = 0; row < 8; row++) {
+        changed = _this->_raw[row] ^ _this->state[row];
+        _this->state[row] = _this->_raw[row];
+
+        for (column = 0; column < 8; column++) {
+            if (_this->_raw[row] & (1 << column)) {
+                key_cnt++;
+            }
+
+            if ((changed & (1 << column)) && _this->_on_key) {
+                _this->_on_key(_this->_owner, IO_keypad_key(row, column), _this->_raw[row] & (1 << column));
+            }
+        }
+    }
+
+    _this->key_cnt = key_cnt;
+}
+
+static void _scan_complete(IO_keypad_t *_this) {
+
+    if (_this->_scan_changed) {
+        _this->_scan_changed = false;
+        _this->_stable_cnt = 0;
+    }
+    else if (_this->_stable_cnt < IO_KEYPAD_DEBOUNCE_CNT && ++_this->_stable_cnt == IO_KEYPAD_DEBOUNCE_CNT) {
+        _state_accept(_this);
+    }
+
+    // all keys released
+    if (_this->_stable_cnt == IO_KEYPAD_DEBOUNCE_CNT && ! _this->key_cnt && ! _this->ghosting && _idle_arm(_this)) {
+        timer_channel_stop(_this->_handle);
+        _this->scanning = false;
+
+        return;
+    }
+
+    _row_select(_this, 0);
+}
+
+// -------------------------------------------------------------------------------------
+
+static void _edge_handler(IO_keypad_t *_this) {
+
+    // no more edge interrupts until all keys released
+    vector_set_enabled(_this->_column_handle, false);
+
+    if ( ! _this->scanning) {
+        _scan_start(_this);
+    }
+}
+
+static void _scan_handler(IO_keypad_t *_this) {
+    IO_pin_handle_t *column = _this->_column_handle;
+    uint8_t columns;
+
+    hw_register_16(_this->_handle->_CCRn_register) += _this->_row_period;
+
+    // pressed key pulls column low
+    columns = ~IO_pin_handle_reg(column, IN) & column->_pin_mask;
+
+    if (columns != _this->_raw[_this->_row]) {
+        _this->_raw[_this->_row] = columns;
+        _this->_scan_changed = true;
+    }
+
+    if ( ! _row_select(_this, _this->_row + 1)) {
+        _scan_complete(_this);
+    }
+}
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _start(IO_keypad_t *_this) {
+    uint8_t row;
+
+    if (_this->active) {
+        return IO_KEYPAD_ACTIVE;
+    }
+
+    for (row = 0; row < 8; row++) {
+        _this->_raw[row] = _this->state[row] = 0;
+    }
+
+    _this->key_cnt = 0;
+    _this->ghosting = false;
+
+    // rows output low, columns input with pull-up
+    IO_pin_handle_reg_reset(_this->_row_handle, OUT);
+    IO_pin_handle_reg_set(_this->_row_handle, DIR);
+    IO_pin_handle_reg_reset(_this->_column_handle, DIR);
+    IO_pin_handle_reg_set(_this->_column_handle, OUT);
+    IO_pin_handle_reg_set(_this->_column_handle, REN);
+
+    interrupt_suspend();
+
+    if ( ! _idle_arm(_this)) {
+        _scan_start(_this);
+    }
+
+    _this->active = true;
+
+    interrupt_restore();
+
+    return IO_KEYPAD_OK;
+}
+
+static uint8_t _stop(IO_keypad_t *_this) {
+
+    interrupt_suspend();
+
+    vector_set_enabled(_this->_column_handle, false);
+    timer_channel_stop(_this->_handle);
+
+    IO_pin_handle_reg_set(_this->_row_handle, DIR);
+
+    _this->scanning = false;
+    _this->active = false;
+
+    interrupt_restore();
+
+    return IO_KEYPAD_OK;
+}
+
+// -------------------------------------------------------------------------------------
+
+// IO_keypad_t destructor
+static dispose_function_t _IO_keypad_dispose(IO_keypad_t *_this) {
+
+    _this->stop(_this);
+
+    _this->_on_key = NULL;
+
+    _this->start = (uint8_t (*)(IO_keypad_t *)) _unsupported_operation;
+    _this->stop = (uint8_t (*)(IO_keypad_t *)) _unsupported_operation;
+
+    return NULL;
+}
+
+// IO_keypad_t constructor
+uint8_t IO_keypad_register(IO_keypad_t *keypad, IO_pin_handle_t *row_handle, IO_pin_handle_t *column_handle,
+        Timer_channel_handle_t *handle, uint16_t row_period, bool diodes) {
+
+    zerofill(keypad);
+
+    // private
+    keypad->_row_handle = row_handle;
+    keypad->_column_handle = column_handle;
+    keypad->_handle = handle;
+    keypad->_row_period = row_period;
+    keypad->_diodes = diodes;
+    keypad->_owner = keypad;
+
+    if ( ! vector_register_handler(column_handle, _edge_handler, keypad, NULL)) {
+        return IO_KEYPAD_VECTOR_SLOT_UNAVAILABLE;
+    }
+
+    if ( ! vector_register_handler(handle, _scan_handler, keypad, NULL)) {
+        vector_release_handler(column_handle);
+
+        return IO_KEYPAD_VECTOR_SLOT_UNAVAILABLE;
+    }
+
+    vector_set_enabled(column_handle, false);
+
+    // public
+    keypad->start = _start;
+    keypad->stop = _stop;
+
+    __dispose_hook_register(keypad, _IO_keypad_dispose);
+
+    return IO_KEYPAD_OK;
+}
@@ -0,0 +1,392 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2018-2019 Mutant Industries ltd.
+#include <driver/IO/logic_capture.h>
+#include <stddef.h>
+#include <driver/interrupt.h>
+
+
+// DMA controller support check {@see DMA.h}
+#ifdef __DMA_CONTROLLER_SUPPORT__
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _unsupported_operation() {
+    return IO_LOGIC_CAPTURE_UNSUPPORTED_OPERATION;
+}
+
+static inline void *_buffer_address(IO_logic_capture_t *_this, uint16_t index) {
+    return (uint8_t *) _this->_config.buffer + (_this->_config.word_access ? index << 1 : index);
+}
+
+static inline uint16_t _port_read(IO_logic_capture_t *_this) {
+    return _this->_config.word_access ? hw_register_16(_this->_data_register) : hw_register_8(_this->_data_register);
+}
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Stop sample clock (timer keeps counter value), get buffer index of next sample
+ */
+static uint16_t _sampling_hold(IO_logic_capture_t *_this) {
+    DMA_channel_handle_t *channel = _this->_config.DMA_channel;
+    uint16_t control_register = _this->_config.sample_handle->_driver->_CTL_register;
+
+    _this->_sample_clock_mode = hw_register_16(control_register) & MC;
+    hw_register_16(control_register) &= ~MC;
+
+    // buffer wrap not serviced yet, DMAxSZ reloaded already
+    if (hw_register_16(channel->_CTL_register) & DMAIFG) {
+        vector_clear_interrupt_flag(channel);
+        _this->_filled = true;
+    }
+
+    return _this->_config.length - DMA_channel_size(channel);
+}
+
+static void _sampling_release(IO_logic_capture_t *_this) {
+
+    if (_this->active) {
+        hw_register_16(_this->_config.sample_handle->_driver->_CTL_register) |= _this->_sample_clock_mode;
+    }
+}
+
+static void _capture_complete(IO_logic_capture_t *_this, uint16_t end_index) {
+    IO_logic_capture_config_t *config = &_this->_config;
+
+    timer_channel_stop(config->sample_handle);
+    DMA_channel_set_enabled(config->DMA_channel, false);
+    vector_set_enabled(config->DMA_channel, false);
+
+    if (_this->_filled) {
+        _this->_oldest_index = end_index == config->length ? 0 : end_index;
+        _this->sample_cnt = config->length;
+    }
+    else {
+        _this->_oldest_index = 0;
+        _this->sample_cnt = end_index;
+    }
+
+    _this->trigger_sample = (uint16_t) (((uint32_t) _this->_trigger_index + config->length - _this->_oldest_index) % config->length);
+
+    _this->active = false;
+    _this->complete = true;
+
+    if (_this->_on_complete) {
+        _this->_on_complete(_this->_owner, _this->_event_arg);
+    }
+}
+
+/**
+ * Switch DMA to single transfer of given count of samples from given index, sample clock must be held
+ */
+static void _post_trigger_finish(IO_logic_capture_t *_this, uint16_t index, uint16_t sample_cnt) {
+    IO_logic_capture_config_t *config = &_this->_config;
+    uint16_t src_type = config->word_access ? DMASRCBYTE__WORD : DMASRCBYTE__BYTE;
+    uint16_t dst_type = config->word_access ? DMADSTBYTE__WORD : DMADSTBYTE__BYTE;
+
+    if ( ! sample_cnt) {
+        _capture_complete(_this, index);
+
+        return;
+    }
+
+    DMA_channel_set_enabled(config->DMA_channel, false);
+    DMA_channel_set_control(config->DMA_channel, DMALEVEL__EDGE, src_type, dst_type,
+            DMASRCINCR_0, DMADSTINCR_3, DMADT_0);
+
+    DMA_channel_destination_address(config->DMA_channel) = _buffer_address(_this, index);
+    DMA_channel_size(config->DMA_channel) = sample_cnt;
+    _this->_end_index = index + sample_cnt;
+
+    vector_clear_interrupt_flag(config->DMA_channel);
+    DMA_channel_set_enabled(config->DMA_channel, true);
+}
+
+static void _trigger_apply(IO_logic_capture_t *_this) {
+    IO_logic_capture_config_t *config = &_this->_config;
+    uint16_t index;
+
+    index = _sampling_hold(_this);
+
+    _this->_triggered = true;
+    _this->_trigger_index = index;
+
+    if (config->trigger_handle) {
+        vector_set_enabled(config->trigger_handle, false);
+    }
+
+    if ((uint32_t) index + config->post_trigger_cnt <= config->length) {
+        _post_trigger_finish(_this, index, config->post_trigger_cnt);
+    }
+    else {
+        // circular transfer continues, the rest is scheduled on buffer wrap
+        _this->_post_remaining = config->post_trigger_cnt - (config->length - index);
+    }
+
+    _sampling_release(_this);
+}
+
+// -------------------------------------------------------------------------------------
+
+static void _DMA_handler(IO_logic_capture_t *_this) {
+    uint16_t index;
+
+    if ( ! _this->_triggered) {
+        _this->_filled = true;
+
+        return;
+    }
+
+    if ( ! _this->_post_remaining) {
+        _capture_complete(_this, _this->_end_index);
+
+        return;
+    }
+
+    // buffer wrapped after trigger, samples written since wrap count as post-trigger already
+    index = _sampling_hold(_this);
+
+    _this->_filled = true;
+    _post_trigger_finish(_this, index, _this->_post_remaining > index ? _this->_post_remaining - index : 0);
+    _this->_post_remaining = 0;
+
+    _sampling_release(_this);
+}
+
+static void _trigger_handler(IO_logic_capture_t *_this) {
+
+    if ( ! _this->active || _this->_triggered) {
+        return;
+    }
+
+    if ((_port_read(_this) & _this->_config.pattern_mask) != _this->_config.pattern_value) {
+        return;
+    }
+
+    _trigger_apply(_this);
+}
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _start(IO_logic_capture_t *_this) {
+    IO_logic_capture_config_t *config = &_this->_config;
+    uint16_t src_type = config->word_access ? DMASRCBYTE__WORD : DMASRCBYTE__BYTE;
+    uint16_t dst_type = config->word_access ? DMADSTBYTE__WORD : DMADSTBYTE__BYTE;
+
+    if (_this->active) {
+        return IO_LOGIC_CAPTURE_ACTIVE;
+    }
+
+    _this->_filled = false;
+    _this->_triggered = false;
+    _this->_post_remaining = 0;
+    _this->sample_cnt = 0;
+    _this->trigger_sample = 0;
+    _this->complete = false;
+
+    // PxIN source, destination incremented, repeated over circular buffer
+    DMA_channel_select_trigger(config->DMA_channel, config->DMA_trigger);
+    DMA_channel_set_control(config->DMA_channel, DMALEVEL__EDGE, src_type, dst_type,
+            DMASRCINCR_0, DMADSTINCR_3, DMADT_4);
+
+    DMA_channel_source_address(config->DMA_channel) = (void *) _this->_data_register;
+    DMA_channel_destination_address(config->DMA_channel) = config->buffer;
+    DMA_channel_size(config->DMA_channel) = config->length;
+
+    // one interrupt per buffer wrap
+    vector_clear_interrupt_flag(config->DMA_channel);
+    vector_set_enabled(config->DMA_channel, true);
+
+    DMA_channel_set_enabled(config->DMA_channel, true);
+
+    // sample clock
+    timer_channel_set_compare_mode(config->sample_handle, OUTMOD_0);
+    timer_channel_set_compare_value(config->sample_handle, config->sample_period - 1);
+    vector_set_enabled(config->sample_handle, false);
+
+    interrupt_suspend();
+
+    _this->active = true;
+
+    timer_channel_start(config->sample_handle);
+
+    if (config->trigger_handle) {
+        IO_pin_handle_reg_reset(config->trigger_handle, IFG);
+        vector_set_enabled(config->trigger_handle, true);
+    }
+
+    interrupt_restore();
+
+    return IO_LOGIC_CAPTURE_OK;
+}
+
+static uint8_t _stop(IO_logic_capture_t *_this) {
+    IO_logic_capture_config_t *config = &_this->_config;
+
+    interrupt_suspend();
+
+    if (config->trigger_handle) {
+        vector_set_enabled(config->trigger_handle, false);
+    }
+
+    if (_this->active) {
+        timer_channel_stop(config->sample_handle);
+    }
+
+    DMA_channel_set_enabled(config->DMA_channel, false);
+    vector_set_enabled(config->DMA_channel, false);
+
+    _this->active = false;
+
+    interrupt_restore();
+
+    return IO_LOGIC_CAPTURE_OK;
+}
+
+static uint8_t _trigger(IO_logic_capture_t *_this) {
+
+    interrupt_suspend();
+
+    if ( ! _this->active || _this->_triggered) {
+        interrupt_restore();
+
+        return IO_LOGIC_CAPTURE_NOT_ACTIVE;
+    }
+
+    _trigger_apply(_this);
+
+    interrupt_restore();
+
+    return IO_LOGIC_CAPTURE_OK;
+}
+
+// -------------------------------------------------------------------------------------
+
+uint16_t IO_logic_capture_sample(IO_logic_capture_t *capture, uint16_t index) {
+    uint32_t position = (uint32_t) capture->_oldest_index + index;
+
+    if (position >= capture->_config.length) {
+        position -= capture->_config.length;
+    }
+
+    return capture->_config.word_access ? ((uint16_t *) capture->_config.buffer)[position]
+            : ((uint8_t *) capture->_config.buffer)[position];
+}
+
+static void _UART_write(UART_driver_t *uart, uint8_t data) {
+
+    while ( ! UART_is_TX_buffer_empty(uart));
+
+    UART_TX_buffer(uart) = data;
+}
+
+static void _UART_write_word(UART_driver_t *uart, uint16_t data) {
+    _UART_write(uart, (uint8_t) data);
+    _UART_write(uart, (uint8_t) (data >> 8));
+}
+
+uint8_t IO_logic_capture_export(IO_logic_capture_t *capture, UART_driver_t *uart) {
+    bool word_access = capture->_config.word_access;
+    uint16_t index, sample, run_sample;
+    uint8_t run_length = 0;
+
+    if ( ! capture->complete || ! capture->sample_cnt) {
+        return IO_LOGIC_CAPTURE_EMPTY;
+    }
+
+    _UART_write(uart, IO_LOGIC_CAPTURE_EXPORT_MAGIC_0);
+    _UART_write(uart, IO_LOGIC_CAPTURE_EXPORT_MAGIC_1);
+    _UART_write(uart, word_access ? 2 : 1);
+    _UART_write_word(uart, capture->sample_cnt);
+    _UART_write_word(uart, capture->trigger_sample);
+    _UART_write_word(uart, capture->_config.sample_period);
+
+    run_sample = IO_logic_capture_sample(capture, 0);
+
+    for (index = 1; index <= capture->sample_cnt; index++) {
+        sample = index < capture->sample_cnt ? IO_logic_capture_sample(capture, index) : ~run_sample;
+
+        if (sample == run_sample && run_length < 0xFF) {
+            run_length++;
+
+            continue;
+        }
+
+        _UART_write(uart, (uint8_t) run_sample);
+
+        if (word_access) {
+            _UART_write(uart, (uint8_t) (run_sample >> 8));
+        }
+
+        _UART_write(uart, run_length);
+
+        run_sample = sample;
+        run_length = 0;
+    }
+
+    return IO_LOGIC_CAPTURE_OK;
+}
+
+// -------------------------------------------------------------------------------------
+
+// IO_logic_capture_t destructor
+static dispose_function_t _IO_logic_capture_dispose(IO_logic_capture_t *_this) {
+
+    _this->stop(_this);
+
+    _this->_on_complete = NULL;
+
+    _this->start = (uint8_t (*)(IO_logic_capture_t *)) _unsupported_operation;
+    _this->stop = (uint8_t (*)(IO_logic_capture_t *)) _unsupported_operation;
+    _this->trigger = (uint8_t (*)(IO_logic_capture_t *)) _unsupported_operation;
+
+    // complete capture can still be read after disposed
+
+    return NULL;
+}
+
+// IO_logic_capture_t constructor
+uint8_t IO_logic_capture_register(IO_logic_capture_t *capture, IO_logic_capture_config_t *config) {
+
+    zerofill(capture);
+
+    // word port must be 16-bit aligned, at least one sample preceding trigger
+    if ((config->word_access && (config->port->_base_register & 0x0001))
+            || ! config->length || config->post_trigger_cnt >= config->length
+            || (config->sample_handle->_driver->_mode & MC) != MC__UP) {
+
+        return IO_LOGIC_CAPTURE_INVALID_CONFIG;
+    }
+
+    // private
+    capture->_config = *config;
+    capture->_data_register = config->port->_base_register + OFS_PxIN;
+    capture->_owner = capture;
+
+    if ( ! vector_register_handler(config->DMA_channel, _DMA_handler, capture, NULL)) {
+        return IO_LOGIC_CAPTURE_VECTOR_SLOT_UNAVAILABLE;
+    }
+
+    vector_set_enabled(config->DMA_channel, false);
+
+    if (config->trigger_handle) {
+        if ( ! vector_register_handler(config->trigger_handle, _trigger_handler, capture, NULL)) {
+            vector_release_handler(config->DMA_channel);
+
+            return IO_LOGIC_CAPTURE_VECTOR_SLOT_UNAVAILABLE;
+        }
+
+        vector_set_enabled(config->trigger_handle, false);
+    }
+
+    // public
+    capture->start = _start;
+    capture->stop = _stop;
+    capture->trigger = _trigger;
+
+    __dispose_hook_register(capture, _IO_logic_capture_dispose);
+
+    return IO_LOGIC_CAPTURE_OK;
+}
+
+#endif /* DMA controller support check */
@@ -0,0 +1,352 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2018-2019 Mutant Industries ltd.
+#include <driver/IO/parallel_bus.h>
+#include <stddef.h>
+#include <driver/interrupt.h>
+
+// -------------------------------------------------------------------------------------
+
+#if ! defined(MC)
+#define MC              (0x0030)        /* Mode control */
+#endif
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _unsupported_operation() {
+    return IO_PARALLEL_BUS_UNSUPPORTED_OPERATION;
+}
+
+/**
+ * Set data direction of whole data port
+ */
+static void _data_direction(IO_parallel_bus_t *_this, bool output) {
+
+    if (_this->_config.word_access) {
+        hw_register_16(_this->_data_register + OFS_PxDIR) = output ? 0xFFFF : 0x0000;
+    }
+    else {
+        hw_register_8(_this->_data_register + OFS_PxDIR) = output ? 0xFF : 0x00;
+    }
+}
+
+/**
+ * Set command / data level and direction of bus cycles that follow
+ */
+static void _cycle_prepare(IO_parallel_bus_t *_this, bool command, bool read) {
+
+    if (_this->_config.command_handle) {
+        if (command) {
+            IO_pin_handle_reg_reset(_this->_config.command_handle, OUT);
+        }
+        else {
+            IO_pin_handle_reg_set(_this->_config.command_handle, OUT);
+        }
+    }
+
+    // 6800 - R/W# level
+    if (_this->_config.mode == PARALLEL_BUS_6800 && _this->_config.read_handle) {
+        if (read) {
+            IO_pin_handle_reg_set(_this->_config.read_handle, OUT);
+        }
+        else {
+            IO_pin_handle_reg_reset(_this->_config.read_handle, OUT);
+        }
+    }
+
+    _data_direction(_this, ! read);
+}
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _select(IO_parallel_bus_t *_this, bool selected) {
+
+    if (_this->_config.select_handle) {
+        if (selected) {
+            IO_pin_handle_reg_reset(_this->_config.select_handle, OUT);
+        }
+        else {
+            IO_pin_handle_reg_set(_this->_config.select_handle, OUT);
+        }
+    }
+
+    return IO_PARALLEL_BUS_OK;
+}
+
+static uint8_t _write(IO_parallel_bus_t *_this, bool command, const void *buffer, uint16_t length) {
+    uint16_t CCTLn_register = _this->_config.strobe_handle->_CCTLn_register;
+    uint16_t OUT_register = _this->_data_register + OFS_PxOUT;
+    const uint16_t *word_data = (const uint16_t *) buffer;
+    const uint8_t *data = (const uint8_t *) buffer;
+
+    if (_this->busy) {
+        return IO_PARALLEL_BUS_BUSY;
+    }
+
+    _cycle_prepare(_this, command, false);
+
+    // data latched on trailing edge of strobe
+    if (_this->_config.word_access) {
+        while (length--) {
+            hw_register_16(OUT_register) = *word_data++;
+            hw_register_16(CCTLn_register) ^= OUT;
+            hw_register_16(CCTLn_register) ^= OUT;
+        }
+    }
+    else {
+        while (length--) {
+            hw_register_8(OUT_register) = *data++;
+            hw_register_16(CCTLn_register) ^= OUT;
+            hw_register_16(CCTLn_register) ^= OUT;
+        }
+    }
+
+    return IO_PARALLEL_BUS_OK;
+}
+
+static uint8_t _read(IO_parallel_bus_t *_this, bool command, void *buffer, uint16_t length) {
+    uint16_t IN_register = _this->_data_register + OFS_PxIN;
+    uint16_t strobe_register, strobe_mask;
+    uint16_t *word_data = (uint16_t *) buffer;
+    uint8_t *data = (uint8_t *) buffer;
+
+    if (_this->busy) {
+        return IO_PARALLEL_BUS_BUSY;
+    }
+
+    // 8080 - RD# pin, 6800 - E (OUT bit of strobe handle)
+    if (_this->_config.mode == PARALLEL_BUS_8080) {
+        strobe_register = _this->_config.read_handle->_base_register + OFS_PxOUT;
+        strobe_mask = _this->_config.read_handle->_pin_mask;
+    }
+    else {
+        strobe_register = _this->_config.strobe_handle->_CCTLn_register;
+        strobe_mask = OUT;
+    }
+
+    _cycle_prepare(_this, command, true);
+
+    // data sampled while strobe is active
+    while (length--) {
+        if (_this->_config.mode == PARALLEL_BUS_8080) {
+            hw_register_8(strobe_register) ^= (uint8_t) strobe_mask;
+        }
+        else {
+            hw_register_16(strobe_register) ^= strobe_mask;
+        }
+
+        if (_this->_config.word_access) {
+            *word_data++ = hw_register_16(IN_register);
+        }
+        else {
+            *data++ = hw_register_8(IN_register);
+        }
+
+        if (_this->_config.mode == PARALLEL_BUS_8080) {
+            hw_register_8(strobe_register) ^= (uint8_t) strobe_mask;
+        }
+        else {
+            hw_register_16(strobe_register) ^= strobe_mask;
+        }
+    }
+
+    _cycle_prepare(_this, command, false);
+
+    return IO_PARALLEL_BUS_OK;
+}
+
+
+// DMA controller support check {@see DMA.h}
+#ifdef __DMA_CONTROLLER_SUPPORT__
+
+static void _transfer_complete_handler(IO_parallel_bus_t *_this) {
+    Timer_channel_handle_t *strobe_handle = _this->_config.strobe_handle;
+
+    vector_set_enabled(_this->_config.DMA_stop_channel, false);
+
+    // handler runs while the last strobe is still active - CCIFG was cleared by the stop write, it is set again
+    // when the strobe goes inactive on CCRn of the last bus cycle
+    while ( ! (hw_register_16(strobe_handle->_CCTLn_register) & CCIFG));
+
+    // back to OUTMOD_0, OUT bit is inactive level
+    hw_register_16(strobe_handle->_CCTLn_register) &= ~OUTMOD;
+
+    timer_channel_stop(strobe_handle);
+    timer_channel_stop(_this->_config.period_handle);
+
+    _this->busy = false;
+
+    if (_this->_on_transfer_complete) {
+        _this->_on_transfer_complete(_this->_owner, _this->_event_arg);
+    }
+}
+
+static uint8_t _write_DMA(IO_parallel_bus_t *_this, bool command, const void *buffer, uint16_t length) {
+    IO_parallel_bus_config_t *config = &_this->_config;
+    uint16_t src_type = config->word_access ? DMASRCBYTE__WORD : DMASRCBYTE__BYTE;
+    uint16_t dst_type = config->word_access ? DMADSTBYTE__WORD : DMADSTBYTE__BYTE;
+    bool mode_8080 = config->mode == PARALLEL_BUS_8080;
+
+    if (_this->busy) {
+        return IO_PARALLEL_BUS_BUSY;
+    }
+
+    if ( ! length) {
+        return IO_PARALLEL_BUS_OK;
+    }
+
+    _cycle_prepare(_this, command, false);
+
+    // one word per bus cycle, channel disabled by hardware after the last one
+    DMA_channel_select_trigger(config->DMA_channel, config->DMA_trigger);
+    DMA_channel_set_control(config->DMA_channel, DMALEVEL__EDGE, src_type, dst_type,
+            DMASRCINCR_3, DMADSTINCR_0, DMADT_0);
+
+    DMA_channel_source_address(config->DMA_channel) = (void *) buffer;
+    DMA_channel_destination_address(config->DMA_channel) = (void *) (_this->_data_register + OFS_PxOUT);
+    DMA_channel_size(config->DMA_channel) = length;
+
+    DMA_channel_set_enabled(config->DMA_channel, true);
+
+    // bus cycle
+    timer_channel_set_compare_mode(config->period_handle, OUTMOD_0);
+    timer_channel_set_compare_value(config->period_handle, config->strobe_period - 1);
+    vector_set_enabled(config->period_handle, false);
+
+    // strobe active from CCR0 to CCRn
+    timer_channel_set_compare_mode(config->strobe_handle, mode_8080 ? OUTMOD_3 : OUTMOD_7);
+    timer_channel_set_compare_value(config->strobe_handle, config->strobe_width);
+    vector_set_enabled(config->strobe_handle, false);
+
+    // after the last transfer the strobe goes inactive on CCRn and stays so
+    _this->_strobe_stop = (hw_register_16(config->strobe_handle->_CCTLn_register) & ~(OUTMOD | CAP | CCIFG))
+            | (mode_8080 ? OUTMOD_1 : OUTMOD_5);
+
+    DMA_channel_select_trigger(config->DMA_stop_channel, config->DMA_stop_trigger);
+    DMA_channel_set_control(config->DMA_stop_channel, DMALEVEL__EDGE, DMASRCBYTE__WORD, DMADSTBYTE__WORD,
+            DMASRCINCR_0, DMADSTINCR_0, DMADT_0);
+
+    DMA_channel_source_address(config->DMA_stop_channel) = &_this->_strobe_stop;
+    DMA_channel_destination_address(config->DMA_stop_channel) = (void *) config->strobe_handle->_CCTLn_register;
+    DMA_channel_size(config->DMA_stop_channel) = 1;
+
+    vector_clear_interrupt_flag(config->DMA_stop_channel);
+    vector_set_enabled(config->DMA_stop_channel, true);
+
+    DMA_channel_set_enabled(config->DMA_stop_channel, true);
+
+    _this->busy = true;
+
+    interrupt_suspend();
+
+    // first word transferred at the end of first bus cycle
+    timer_channel_start(config->period_handle);
+    timer_channel_start(config->strobe_handle);
+
+    interrupt_restore();
+
+    return IO_PARALLEL_BUS_OK;
+}
+
+#endif /* DMA controller support check */
+
+// -------------------------------------------------------------------------------------
+
+// IO_parallel_bus_t destructor
+static dispose_function_t _IO_parallel_bus_dispose(IO_parallel_bus_t *_this) {
+
+#ifdef __DMA_CONTROLLER_SUPPORT__
+    if (_this->busy) {
+        DMA_channel_set_enabled(_this->_config.DMA_channel, false);
+        DMA_channel_set_enabled(_this->_config.DMA_stop_channel, false);
+        vector_set_enabled(_this->_config.DMA_stop_channel, false);
+
+        hw_register_16(_this->_config.strobe_handle->_CCTLn_register) &= ~OUTMOD;
+
+        timer_channel_stop(_this->_config.strobe_handle);
+        timer_channel_stop(_this->_config.period_handle);
+
+        _this->busy = false;
+    }
+#endif
+
+    _this->_on_transfer_complete = NULL;
+
+    _this->select = (uint8_t (*)(IO_parallel_bus_t *, bool)) _unsupported_operation;
+    _this->write = (uint8_t (*)(IO_parallel_bus_t *, bool, const void *, uint16_t)) _unsupported_operation;
+    _this->read = (uint8_t (*)(IO_parallel_bus_t *, bool, void *, uint16_t)) _unsupported_operation;
+    _this->write_DMA = (uint8_t (*)(IO_parallel_bus_t *, bool, const void *, uint16_t)) _unsupported_operation;
+
+    return NULL;
+}
+
+// IO_parallel_bus_t constructor
+uint8_t IO_parallel_bus_register(IO_parallel_bus_t *bus, IO_parallel_bus_config_t *config) {
+
+    zerofill(bus);
+
+    // word port must be 16-bit aligned
+    if (config->word_access && (config->data_port->_base_register & 0x0001)) {
+        return IO_PARALLEL_BUS_INVALID_CONFIG;
+    }
+
+    // private
+    bus->_config = *config;
+    bus->_data_register = config->data_port->_base_register;
+    bus->_strobe_idle = config->mode == PARALLEL_BUS_8080 ? OUT : 0;
+    bus->_owner = bus;
+
+    // strobe output follows OUT bit
+    timer_channel_set_compare_mode(config->strobe_handle, OUTMOD_0);
+    vector_set_enabled(config->strobe_handle, false);
+    hw_register_16(config->strobe_handle->_CCTLn_register) =
+            (hw_register_16(config->strobe_handle->_CCTLn_register) & ~OUT) | bus->_strobe_idle;
+
+    if (config->read_handle) {
+        // 8080 - RD# inactive, 6800 - write direction
+        if (config->mode == PARALLEL_BUS_8080) {
+            IO_pin_handle_reg_set(config->read_handle, OUT);
+        }
+        else {
+            IO_pin_handle_reg_reset(config->read_handle, OUT);
+        }
+
+        IO_pin_handle_reg_set(config->read_handle, DIR);
+    }
+
+    if (config->select_handle) {
+        IO_pin_handle_reg_set(config->select_handle, OUT);
+        IO_pin_handle_reg_set(config->select_handle, DIR);
+    }
+
+    if (config->command_handle) {
+        IO_pin_handle_reg_set(config->command_handle, DIR);
+    }
+
+    _data_direction(bus, true);
+
+    // public
+    bus->select = _select;
+    bus->write = _write;
+    bus->read = config->read_handle ? _read : (uint8_t (*)(IO_parallel_bus_t *, bool, void *, uint16_t)) _unsupported_operation;
+    bus->write_DMA = (uint8_t (*)(IO_parallel_bus_t *, bool, const void *, uint16_t)) _unsupported_operation;
+
+#ifdef __DMA_CONTROLLER_SUPPORT__
+    if (config->DMA_channel && config->DMA_stop_channel && config->period_handle) {
+        if ((config->period_handle->_driver->_mode & MC) != MC__UP) {
+            return IO_PARALLEL_BUS_INVALID_CONFIG;
+        }
+
+        if ( ! vector_register_handler(config->DMA_stop_channel, _transfer_complete_handler, bus, NULL)) {
+            return IO_PARALLEL_BUS_VECTOR_SLOT_UNAVAILABLE;
+        }
+
+        vector_set_enabled(config->DMA_stop_channel, false);
+
+        bus->write_DMA = _write_DMA;
+    }
+#endif
+
+    __dispose_hook_register(bus, _IO_parallel_bus_dispose);
+
+    return IO_PARALLEL_BUS_OK;
+}
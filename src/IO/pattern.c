@@ -0,0 +1,262 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2018-2019 Mutant Industries ltd.
+#include <driver/IO/pattern.h>
+#include <stddef.h>
+#include <driver/interrupt.h>
+
+
+// DMA controller support check {@see DMA.h}
+#ifdef __DMA_CONTROLLER_SUPPORT__
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _unsupported_operation() {
+    return IO_PATTERN_UNSUPPORTED_OPERATION;
+}
+
+/**
+ * Set source address register of both channels - while channel is enabled the value is used on next block reload
+ */
+static inline void _source_set(IO_pattern_t *_this, const void *data, const uint16_t *timing) {
+
+    DMA_channel_source_address(_this->_config.DMA_channel) = (void *) data;
+
+    if (timing) {
+        DMA_channel_source_address(_this->_config.DMA_timing_channel) = (void *) timing;
+    }
+}
+
+static void _generation_stop(IO_pattern_t *_this) {
+    IO_pattern_config_t *config = &_this->_config;
+
+    timer_channel_stop(config->period_handle);
+
+    DMA_channel_set_enabled(config->DMA_channel, false);
+    vector_set_enabled(config->DMA_channel, false);
+
+    if (config->DMA_timing_channel) {
+        DMA_channel_set_enabled(config->DMA_timing_channel, false);
+    }
+
+    _this->busy = false;
+}
+
+/**
+ * Start generation, next_data (and next_timing) is loaded by hardware at the end of first block in repeated mode
+ */
+static void _generation_start(IO_pattern_t *_this, const void *data, const uint16_t *timing, uint16_t length,
+        uint16_t transfer_mode, bool complete_interrupt, const void *next_data, const uint16_t *next_timing) {
+
+    IO_pattern_config_t *config = &_this->_config;
+    uint16_t src_type = config->word_access ? DMASRCBYTE__WORD : DMASRCBYTE__BYTE;
+    uint16_t dst_type = config->word_access ? DMADSTBYTE__WORD : DMADSTBYTE__BYTE;
+
+    // one pattern per step, source incremented
+    DMA_channel_select_trigger(config->DMA_channel, config->DMA_trigger);
+    DMA_channel_set_control(config->DMA_channel, DMALEVEL__EDGE, src_type, dst_type,
+            DMASRCINCR_3, DMADSTINCR_0, transfer_mode);
+
+    DMA_channel_source_address(config->DMA_channel) = (void *) data;
+    DMA_channel_destination_address(config->DMA_channel) = (void *) _this->_data_register;
+    DMA_channel_size(config->DMA_channel) = length;
+
+    if (timing) {
+        // duration of step written to CCR0 right after the step begins
+        DMA_channel_select_trigger(config->DMA_timing_channel, config->DMA_timing_trigger);
+        DMA_channel_set_control(config->DMA_timing_channel, DMALEVEL__EDGE, DMASRCBYTE__WORD, DMADSTBYTE__WORD,
+                DMASRCINCR_3, DMADSTINCR_0, transfer_mode);
+
+        DMA_channel_source_address(config->DMA_timing_channel) = (void *) timing;
+        DMA_channel_destination_address(config->DMA_timing_channel) = (void *) config->period_handle->_CCRn_register;
+        DMA_channel_size(config->DMA_timing_channel) = length;
+
+        DMA_channel_set_enabled(config->DMA_timing_channel, true);
+    }
+
+    DMA_channel_set_enabled(config->DMA_channel, true);
+
+    // source of first block is latched on enable, so the next one is set before the first trigger
+    if (next_data) {
+        _source_set(_this, next_data, next_timing);
+    }
+
+    vector_clear_interrupt_flag(config->DMA_channel);
+    vector_set_enabled(config->DMA_channel, complete_interrupt);
+
+    timer_channel_set_compare_mode(config->period_handle, OUTMOD_0);
+    timer_channel_set_compare_value(config->period_handle, config->step_period - 1);
+    vector_set_enabled(config->period_handle, false);
+
+    _this->busy = true;
+
+    interrupt_suspend();
+
+    timer_channel_start(config->period_handle);
+
+    interrupt_restore();
+}
+
+/**
+ * Copy last entry of stream buffer being played, it is reloaded by hardware after the buffer ends
+ */
+static void _last_step_copy(IO_pattern_t *_this) {
+    uint16_t last = _this->_length - 1;
+
+    _this->_last_pattern = _this->_config.word_access ? ((const uint16_t *) _this->_data[_this->_playing])[last]
+            : ((const uint8_t *) _this->_data[_this->_playing])[last];
+
+    if (_this->_timing[_this->_playing]) {
+        _this->_last_timing = _this->_timing[_this->_playing][last];
+    }
+}
+
+// -------------------------------------------------------------------------------------
+
+static void _transfer_complete_handler(IO_pattern_t *_this) {
+    uint8_t played;
+
+    if (_this->_stream && ! _this->_ending) {
+        // the other buffer has been reloaded by hardware and is playing now
+        played = _this->_playing;
+        _this->_playing ^= 1;
+
+        if (_this->_on_refill && _this->_on_refill(_this->_owner, played)) {
+            _source_set(_this, _this->_data[played], _this->_timing[played]);
+
+            return;
+        }
+
+        // stop at the end of buffer being played, block reloaded before the stop repeats its last step
+        _last_step_copy(_this);
+        _source_set(_this, &_this->_last_pattern, _this->_timing[_this->_playing] ? &_this->_last_timing : NULL);
+
+        _this->_ending = true;
+
+        return;
+    }
+
+    _generation_stop(_this);
+
+    if (_this->_on_complete) {
+        _this->_on_complete(_this->_owner, _this->_event_arg);
+    }
+}
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _write(IO_pattern_t *_this, const void *data, const uint16_t *timing, uint16_t length, bool loop) {
+
+    if (_this->busy) {
+        return IO_PATTERN_BUSY;
+    }
+
+    if (timing && ! _this->_config.DMA_timing_channel) {
+        return IO_PATTERN_INVALID_CONFIG;
+    }
+
+    if ( ! length) {
+        return IO_PATTERN_OK;
+    }
+
+    _this->_stream = false;
+
+    _generation_start(_this, data, timing, length, loop ? DMADT_4 : DMADT_0, ! loop, NULL, NULL);
+
+    return IO_PATTERN_OK;
+}
+
+static uint8_t _stream(IO_pattern_t *_this, const void *data_0, const void *data_1,
+        const uint16_t *timing_0, const uint16_t *timing_1, uint16_t length) {
+
+    if (_this->busy) {
+        return IO_PATTERN_BUSY;
+    }
+
+    if ( ! timing_0 != ! timing_1 || (timing_0 && ! _this->_config.DMA_timing_channel)) {
+        return IO_PATTERN_INVALID_CONFIG;
+    }
+
+    if ( ! length) {
+        return IO_PATTERN_OK;
+    }
+
+    _this->_stream = true;
+    _this->_ending = false;
+    _this->_playing = 0;
+    _this->_data[0] = data_0;
+    _this->_data[1] = data_1;
+    _this->_timing[0] = timing_0;
+    _this->_timing[1] = timing_1;
+    _this->_length = length;
+
+    // second buffer loaded at the end of first one
+    _generation_start(_this, data_0, timing_0, length, DMADT_4, true, data_1, timing_1);
+
+    return IO_PATTERN_OK;
+}
+
+static uint8_t _stop(IO_pattern_t *_this) {
+
+    interrupt_suspend();
+
+    if (_this->busy) {
+        _generation_stop(_this);
+    }
+
+    interrupt_restore();
+
+    return IO_PATTERN_OK;
+}
+
+// -------------------------------------------------------------------------------------
+
+// IO_pattern_t destructor
+static dispose_function_t _IO_pattern_dispose(IO_pattern_t *_this) {
+
+    _this->stop(_this);
+
+    _this->_on_complete = NULL;
+    _this->_on_refill = NULL;
+
+    _this->write = (uint8_t (*)(IO_pattern_t *, const void *, const uint16_t *, uint16_t, bool)) _unsupported_operation;
+    _this->stream = (uint8_t (*)(IO_pattern_t *, const void *, const void *,
+            const uint16_t *, const uint16_t *, uint16_t)) _unsupported_operation;
+    _this->stop = (uint8_t (*)(IO_pattern_t *)) _unsupported_operation;
+
+    return NULL;
+}
+
+// IO_pattern_t constructor
+uint8_t IO_pattern_register(IO_pattern_t *pattern, IO_pattern_config_t *config) {
+
+    zerofill(pattern);
+
+    // word port must be 16-bit aligned
+    if ((config->word_access && (config->port->_base_register & 0x0001))
+            || (config->period_handle->_driver->_mode & MC) != MC__UP) {
+
+        return IO_PATTERN_INVALID_CONFIG;
+    }
+
+    // private
+    pattern->_config = *config;
+    pattern->_data_register = config->port->_base_register + OFS_PxOUT;
+    pattern->_owner = pattern;
+
+    if ( ! vector_register_handler(config->DMA_channel, _transfer_complete_handler, pattern, NULL)) {
+        return IO_PATTERN_VECTOR_SLOT_UNAVAILABLE;
+    }
+
+    vector_set_enabled(config->DMA_channel, false);
+
+    // public
+    pattern->write = _write;
+    pattern->stream = _stream;
+    pattern->stop = _stop;
+
+    __dispose_hook_register(pattern, _IO_pattern_dispose);
+
+    return IO_PATTERN_OK;
+}
+
+#endif /* DMA controller support check */
@@ -0,0 +1,214 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2018-2019 Mutant Industries ltd.
+#include <driver/IO/quadrature.h>
+#include <stddef.h>
+#include <driver/interrupt.h>
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Both channels changed at once
+ */
+#define QUADRATURE_ILLEGAL      (2)
+
+/**
+ * Position change indexed by (previous state << 2 | state), state = (A << 1 | B)
+ *  - 00 -> 10 -> 11 -> 01 -> 00 ~ A leads B ~ increment
+ */
+static const int8_t _transition_table[16] = {
+    // 00 -> 00, 01, 10, 11
+    0, -1, 1, QUADRATURE_ILLEGAL,
+    // 01 -> 00, 01, 10, 11
+    1, 0, QUADRATURE_ILLEGAL, -1,
+    // 10 -> 00, 01, 10, 11
+    -1, QUADRATURE_ILLEGAL, 0, 1,
+    // 11 -> 00, 01, 10, 11
+    QUADRATURE_ILLEGAL, 1, -1, 0
+};
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _unsupported_operation() {
+    return IO_QUADRATURE_UNSUPPORTED_OPERATION;
+}
+
+static inline uint8_t _state_decode(IO_quadrature_t *_this, uint8_t input) {
+    return (input & _this->_pin_A ? 2 : 0) | (input & _this->_pin_B ? 1 : 0);
+}
+
+/**
+ * Set edge select of both pins opposite to their levels, clear flags
+ */
+static inline void _edge_select(IO_quadrature_t *_this, uint8_t levels) {
+    uint8_t pin_mask = _this->_pin_A | _this->_pin_B;
+
+    IO_pin_handle_reg(_this->_handle, IES) = (IO_pin_handle_reg(_this->_handle, IES) & ~pin_mask) | levels;
+    IO_pin_handle_reg(_this->_handle, IFG) &= ~pin_mask;
+}
+
+// -------------------------------------------------------------------------------------
+
+static void _edge_handler(IO_quadrature_t *_this) {
+    uint8_t channel_mask = _this->_pin_A | _this->_pin_B;
+    uint16_t timestamp = IO_port_timestamp(_this->_handle->_driver);
+    uint8_t levels, state;
+    int8_t delta;
+
+    levels = IO_pin_handle_reg(_this->_handle, IN) & channel_mask;
+
+    do {
+        state = _state_decode(_this, levels);
+        delta = _transition_table[(_this->_state << 2) | state];
+        _this->_state = state;
+
+        if (delta == QUADRATURE_ILLEGAL) {
+            _this->error_cnt++;
+        }
+        else if (delta) {
+            _this->_position += delta;
+
+            // edges serviced in one execution share timestamp
+            if (timestamp != _this->_timestamp_last) {
+                _this->_interval = timestamp - _this->_timestamp_last;
+                _this->_timestamp_last = timestamp;
+            }
+
+            _this->_direction = delta;
+        }
+
+        _edge_select(_this, levels);
+
+    // edge occurred before flags were cleared
+    } while ((levels = IO_pin_handle_reg(_this->_handle, IN) & channel_mask) != (IO_pin_handle_reg(_this->_handle, IES) & channel_mask));
+}
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _start(IO_quadrature_t *_this) {
+    uint8_t pin_mask = _this->_pin_A | _this->_pin_B;
+    uint8_t levels;
+
+    interrupt_suspend();
+
+    do {
+        levels = IO_pin_handle_reg(_this->_handle, IN) & pin_mask;
+        _edge_select(_this, levels);
+    } while ((IO_pin_handle_reg(_this->_handle, IN) & pin_mask) != levels);
+
+    _this->_state = _state_decode(_this, levels);
+    _this->_interval = 0;
+
+    vector_set_enabled(_this->_handle, true);
+
+    _this->active = true;
+
+    interrupt_restore();
+
+    return IO_QUADRATURE_OK;
+}
+
+static uint8_t _stop(IO_quadrature_t *_this) {
+
+    vector_set_enabled(_this->_handle, false);
+
+    _this->active = false;
+
+    return IO_QUADRATURE_OK;
+}
+
+static uint8_t _get_position(IO_quadrature_t *_this, int32_t *target) {
+
+    interrupt_suspend();
+
+    *target = _this->_position;
+
+    interrupt_restore();
+
+    return IO_QUADRATURE_OK;
+}
+
+static uint8_t _set_position(IO_quadrature_t *_this, int32_t position) {
+
+    interrupt_suspend();
+
+    _this->_position = position;
+
+    interrupt_restore();
+
+    return IO_QUADRATURE_OK;
+}
+
+// -------------------------------------------------------------------------------------
+
+int32_t IO_quadrature_velocity(IO_quadrature_t *encoder, uint16_t now, uint32_t frequency) {
+    uint16_t interval, elapsed;
+    int8_t direction;
+    int32_t velocity;
+
+    interrupt_suspend();
+
+    interval = encoder->_interval;
+    elapsed = now - encoder->_timestamp_last;
+    direction = encoder->_direction;
+
+    interrupt_restore();
+
+    if ( ! interval) {
+        return 0;
+    }
+
+    if (elapsed > interval) {
+        interval = elapsed;
+    }
+
+    velocity = (int32_t) (frequency / interval);
+
+    return direction < 0 ? -velocity : velocity;
+}
+
+// -------------------------------------------------------------------------------------
+
+// IO_quadrature_t destructor
+static dispose_function_t _IO_quadrature_dispose(IO_quadrature_t *_this) {
+
+    _this->stop(_this);
+
+    _this->start = (uint8_t (*)(IO_quadrature_t *)) _unsupported_operation;
+    _this->stop = (uint8_t (*)(IO_quadrature_t *)) _unsupported_operation;
+    _this->set_position = (uint8_t (*)(IO_quadrature_t *, int32_t)) _unsupported_operation;
+
+    // position can still be read after disposed
+
+    return NULL;
+}
+
+// IO_quadrature_t constructor
+uint8_t IO_quadrature_register(IO_quadrature_t *encoder, IO_pin_handle_t *handle, uint8_t pin_A, uint8_t pin_B) {
+
+    zerofill(encoder);
+
+    if ( ! pin_A || ! pin_B || (handle->_pin_mask & (pin_A | pin_B)) != (pin_A | pin_B)) {
+        return IO_QUADRATURE_INVALID_CONFIG;
+    }
+
+    // private
+    encoder->_handle = handle;
+    encoder->_pin_A = pin_A;
+    encoder->_pin_B = pin_B;
+
+    if ( ! vector_register_handler(handle, _edge_handler, encoder, NULL)) {
+        return IO_QUADRATURE_VECTOR_SLOT_UNAVAILABLE;
+    }
+
+    vector_set_enabled(handle, false);
+
+    // public
+    encoder->start = _start;
+    encoder->stop = _stop;
+    encoder->get_position = _get_position;
+    encoder->set_position = _set_position;
+
+    __dispose_hook_register(encoder, _IO_quadrature_dispose);
+
+    return IO_QUADRATURE_OK;
+}
@@ -24,6 +24,20 @@
 #define UC7BIT__8BIT    (0x0000)        /* 8-bit data */
 #endif
 
+/**
+ * Fractional portion of N = f_BRCLK / baudrate [1/10000] -> UCBRSx
+ *  - {@see MSP430 user guide, 'UCBRSx Settings for Fractional Portion of N = fBRCLK / Baud Rate'}
+ */
+static const uint16_t _modulation_fraction[] = {
+        0, 529, 715, 835, 1001, 1252, 1430, 1670, 2147, 2224, 2503, 3000, 3335, 3575, 3753, 4003, 4286, 4378,
+        5002, 5715, 6003, 6254, 6432, 6667, 7001, 7147, 7503, 7861, 8004, 8333, 8464, 8572, 8751, 9004, 9170, 9288
+};
+
+static const uint8_t _modulation_pattern[] = {
+        0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x11, 0x21, 0x22, 0x44, 0x25, 0x49, 0x4A, 0x52, 0x92, 0x53, 0x55,
+        0xAA, 0x6B, 0xAD, 0xB5, 0xB6, 0xD6, 0xB7, 0xBB, 0xDD, 0xED, 0xEE, 0xBF, 0xDF, 0xEF, 0xF7, 0xFB, 0xFD, 0xFE
+};
+
 // -------------------------------------------------------------------------------------
 
 static void _uart_vector_handler(UART_driver_t *driver) {
@@ -187,3 +201,35 @@ void UART_driver_register(UART_driver_t *driver, uint16_t base, uint8_t vector_n
     driver->_on_start_bit_received = NULL;
     driver->_on_transmit_complete = NULL;
 }
+
+// -------------------------------------------------------------------------------------
+
+uint8_t UART_baudrate_config_calculate(UART_baudrate_config_t *config, uint32_t clock_frequency, uint32_t baudrate) {
+    uint32_t division_factor;
+    uint16_t fraction;
+    uint8_t i;
+
+    if ( ! baudrate || clock_frequency < baudrate) {
+        return UART_INVALID_BAUDRATE;
+    }
+
+    // N = f_BRCLK / baudrate, integer and fractional part
+    division_factor = clock_frequency / baudrate;
+    fraction = (uint16_t) (((uint64_t) (clock_frequency % baudrate) * 10000) / baudrate);
+
+    // highest table entry not greater than fractional part
+    for (i = 1; i < sizeof(_modulation_fraction) / sizeof(_modulation_fraction[0]) && _modulation_fraction[i] <= fraction; i++);
+
+    config->second_modulation_stage = _modulation_pattern[i - 1];
+
+    if ((config->oversampling = (division_factor >= 16))) {
+        config->clock_prescaler = (uint16_t) (division_factor / 16);
+        config->first_modulation_stage = (uint8_t) (division_factor % 16);
+    }
+    else {
+        config->clock_prescaler = (uint16_t) division_factor;
+        config->first_modulation_stage = 0;
+    }
+
+    return UART_OK;
+}
@@ -8,32 +8,6 @@
 
 // -------------------------------------------------------------------------------------
 
-/**
- * Input divider expansion register
- */
-#ifdef TAIDEX_0
-#define _TIMER_HAS_IDEX_
-#endif
-
-/**
- * Standard timer register offsets from base address, compatible across all devices.
- */
-#ifdef OFS_TAxCTL
-#define OFS_TxCTL           OFS_TAxCTL
-#define OFS_TxCCTL0         OFS_TAxCCTL0
-#define OFS_TxR             OFS_TAxR
-#define OFS_TxCCR0          OFS_TAxCCR0
-#ifdef _TIMER_HAS_IDEX_
-#define OFS_TxEX0           OFS_TAxEX0
-#endif
-#else
-#define OFS_TxCTL           (0x0000)
-#define OFS_TxCCTL0         (0x0002)
-#define OFS_TxR             (0x0010)
-#define OFS_TxCCR0          (0x0012)
-#define OFS_TxEX0           (0x0020)
-#endif
-
 /**
  * OFS_TxIV in 1xx, 2xx, 3xx and 4xx families depends on timer, OFS_TAxIV != OFS_TBxIV
  */
@@ -64,22 +38,48 @@
 #if ! defined(MC)
 #define MC              (0x0030)        /* Mode control */
 #endif
+#if ! defined(MC__CONTINUOUS)
+#define MC__CONTINUOUS  (0x0020)        /* Continuous up */
+#endif
 #if ! defined(OUTMOD)
 #define OUTMOD          (0x00e0)        /* Output mode */
 #endif
 #if ! defined(CCIS)
 #define CCIS            (0x3000)        /* Capture/compare input select */
 #endif
+#if ! defined(CLLD)
+#define CLLD            (0x0600)        /* Compare latch load source */
+#endif
+#if ! defined(CLLD_0)
+#define CLLD_0          (0x0000)        /* Compare latch load source 0 - immediate */
+#endif
+#if ! defined(TBCLGRP)
+#define TBCLGRP         (0x6000)        /* Timer_B compare latch load group */
+#endif
+#if ! defined(TBCLGRP_1)
+#define TBCLGRP_1       (0x2000)        /* Timer_B compare latch groups - pairs 1&2, 3&4, 5&6 */
+#endif
+#if ! defined(TBCLGRP_2)
+#define TBCLGRP_2       (0x4000)        /* Timer_B compare latch groups - triplets 1-3, 4-6 */
+#endif
+#if ! defined(TBCLGRP_3)
+#define TBCLGRP_3       (0x6000)        /* Timer_B compare latch groups - all together */
+#endif
 
 /**
  * Max threshold of two consecutive reads of counter register
  */
 #define TIMER_THRESHOLD     (50)
 
+/**
+ * Min distance of compare value from counter in periodic mode, closer compare value is considered missed
+ */
+#define TIMER_PERIODIC_MARGIN   (8)
+
 // -------------------------------------------------------------------------------------
 
 static uint8_t _start(Timer_channel_handle_t *_this) {
-    uint16_t CTL_register;
+    uint16_t CTL_register, counter;
     uint8_t result = TIMER_OK;
 
     interrupt_suspend();
@@ -99,6 +99,12 @@ static uint8_t _start(Timer_channel_handle_t *_this) {
             vector_clear_interrupt_flag(_this);
         }
         else {
+            // periodic mode - first compare event one period from now
+            if (_this->_period) {
+                _this->get_counter(_this, &counter);
+                hw_register_16(_this->_CCRn_register) = counter + _this->_period;
+            }
+
             hw_register_16(_this->_CCTLn_register) &= ~CAP;
         }
 
@@ -209,6 +215,8 @@ static void _set_capture_mode(Timer_channel_handle_t *_this, uint16_t mode, uint
     hw_register_16(_this->_CCTLn_register) = (hw_register_16(_this->_CCTLn_register) & ~(CM | CCIS | SCS | OUTMOD)) |
             (CAP | mode | input_select | input_synchronize);
 
+    // periodic mode applies to compare events only
+    _this->_period = 0;
     _this->capture_mode = true;
 }
 
@@ -241,6 +249,59 @@ static void _set_compare_value(Timer_channel_handle_t *_this, uint16_t value) {
     hw_register_16(_this->_CCRn_register) = value;
 }
 
+static void _set_compare_value_latched(Timer_channel_handle_t *_this, uint16_t value) {
+
+    interrupt_suspend();
+
+    _this->_compare_staged = value;
+    _this->_driver->_compare_latch_pending |= (uint8_t) (1 << _this->_CCRx);
+
+    interrupt_restore();
+}
+
+static uint8_t _set_periodic(Timer_channel_handle_t *_this, uint16_t period) {
+
+    // compare value is advanced by shared vector handler relative to free-running counter
+    if ((_this->_driver->_mode & MC) != MC__CONTINUOUS) {
+        return TIMER_REFUSED;
+    }
+
+    // every compare event would be considered missed
+    if (period && period <= TIMER_PERIODIC_MARGIN) {
+        return TIMER_REFUSED;
+    }
+
+    _this->_period = period;
+    _this->overrun_cnt = 0;
+
+    return TIMER_OK;
+}
+
+/**
+ * Advance compare value by period, skip periods that have already passed
+ */
+static void _periodic_advance(Timer_channel_handle_t *handle) {
+    uint16_t counter, compare_value, elapsed, skipped;
+
+    compare_value = hw_register_16(handle->_CCRn_register);
+
+    handle->get_counter(handle, &counter);
+
+    // time since the compare event that triggered this interrupt
+    elapsed = (uint16_t) (counter - compare_value) + TIMER_PERIODIC_MARGIN;
+
+    compare_value += handle->_period;
+
+    if (elapsed >= handle->_period) {
+        skipped = elapsed / handle->_period;
+
+        compare_value += skipped * handle->_period;
+        handle->overrun_cnt += skipped;
+    }
+
+    hw_register_16(handle->_CCRn_register) = compare_value;
+}
+
 // -------------------------------------------------------------------------------------
 
 static void _shared_vector_handler(Timer_driver_t *driver) {
@@ -257,6 +318,11 @@ static void _shared_vector_handler(Timer_driver_t *driver) {
 
     handle = ((Timer_channel_handle_t **) &driver->_CCR1_handle)[interrupt_channel_index];
 
+    // periodic mode, overflow handle period is always zero
+    if (handle->_period) {
+        _periodic_advance(handle);
+    }
+
     // execute handler with given handler arguments
     handle->_handler(handle->_handler_arg_1, handle->_handler_arg_2);
 }
@@ -295,6 +361,13 @@ static dispose_function_t _timer_channel_handle_dispose(Timer_channel_handle_t *
     _this->_handler = NULL;
     _this->_handler_arg_1 = NULL;
     _this->_handler_arg_2 = NULL;
+    _this->_period = 0;
+
+    if (_this == _this->_driver->_compare_latch_handle) {
+        // compare latch emulation not possible anymore, latching disabled
+        _this->_driver->_compare_latch_handle = NULL;
+        _this->_driver->_compare_latch_load_mode = CLLD_0;
+    }
 
     if (_this->handle_type == OVERFLOW) {
         _this->_driver->_overflow_handle = NULL;
@@ -320,8 +393,13 @@ static dispose_function_t _timer_channel_handle_dispose(Timer_channel_handle_t *
         _this->is_capture_overflow_set = (bool (*)(Timer_channel_handle_t *)) _unsupported_operation;
         _this->set_compare_mode = (void (*)(Timer_channel_handle_t *, uint16_t)) _unsupported_operation;
         _this->set_compare_value = (void (*)(Timer_channel_handle_t *, uint16_t)) _unsupported_operation;
+        _this->set_compare_value_latched = (void (*)(Timer_channel_handle_t *, uint16_t)) _unsupported_operation;
+        // drop staged compare value
+        _this->_driver->_compare_latch_pending &= (uint8_t) ~(1 << _this->_CCRx);
     }
 
+    _this->set_periodic = (uint8_t (*)(Timer_channel_handle_t *, uint16_t)) _unsupported_operation;
+
     // timer counter and CCR can still be read after disposed
 
     _this->handle_type = (Timer_handle_type) NULL;
@@ -404,6 +482,8 @@ static uint8_t _channel_handle_register(Timer_driver_t *_this, Timer_channel_han
     handle->_handler_arg_1 = NULL;
     handle->_handler_arg_2 = NULL;
     handle->_dispose_hook = dispose_hook;
+    handle->_period = 0;
+    handle->_CCRx = CCRx;
 
     // public
     if (handle_type != MAIN) {
@@ -421,6 +501,10 @@ static uint8_t _channel_handle_register(Timer_driver_t *_this, Timer_channel_han
     handle->get_counter = _get_counter;
     handle->handle_type = handle_type;
     handle->active = false;
+    handle->overrun_cnt = 0;
+    // periodic mode is supported only on handles serviced by shared interrupt handler
+    handle->set_periodic = handle_type == SHARED ? _set_periodic
+            : (uint8_t (*)(Timer_channel_handle_t *, uint16_t)) _unsupported_operation;
 
     if (handle_type != OVERFLOW) {
         handle->_CCTLn_register = _this->_CTL_register + OFS_TxCCTL0 + (CCRx * 2);
@@ -440,6 +524,7 @@ static uint8_t _channel_handle_register(Timer_driver_t *_this, Timer_channel_han
         handle->set_compare_mode = _set_compare_mode;
         handle->get_capture_value = _get_capture_value;
         handle->set_compare_value = _set_compare_value;
+        handle->set_compare_value_latched = _set_compare_value_latched;
     }
     else {
         handle->set_capture_mode = (void (*)(Timer_channel_handle_t *, uint16_t, uint16_t, uint16_t)) _unsupported_operation;
@@ -447,11 +532,235 @@ static uint8_t _channel_handle_register(Timer_driver_t *_this, Timer_channel_han
         handle->set_compare_mode = (void (*)(Timer_channel_handle_t *, uint16_t)) _unsupported_operation;
         handle->get_capture_value = (uint16_t (*)(Timer_channel_handle_t *)) _unsupported_operation;
         handle->set_compare_value = (void (*)(Timer_channel_handle_t *, uint16_t)) _unsupported_operation;
+        handle->set_compare_value_latched = (void (*)(Timer_channel_handle_t *, uint16_t)) _unsupported_operation;
+    }
+
+    return TIMER_OK;
+}
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Mask of CCRs loaded together with given CCRx in Timer_B latch group mode
+ */
+static uint8_t _compare_latch_group_mask(uint16_t group, uint8_t CCRx) {
+
+    switch (group) {
+        case TBCLGRP_1:
+            return CCRx ? (uint8_t) (0x06 << ((CCRx - 1) & ~1)) : 0x01;
+        case TBCLGRP_2:
+            return CCRx ? (uint8_t) (0x0E << ((CCRx - 1) / 3 * 3)) : 0x01;
+        case TBCLGRP_3:
+            return 0xFF;
+        default:
+            return (uint8_t) (1 << CCRx);
+    }
+}
+
+/**
+ * Write all staged compare values to CCRn registers back-to-back
+ *  - Timer_B group latches are loaded only when every TBCCRn of group has been written, so other members
+ * of touched groups are rewritten with their current value
+ */
+static void _compare_latch_apply(Timer_driver_t *driver) {
+    uint8_t pending = driver->_compare_latch_pending, touched = 0, CCRx;
+    uint16_t group, CCRn_register;
+    Timer_channel_handle_t *handle;
+
+    if (driver->_compare_latch && (group = hw_register_16(driver->_CTL_register) & TBCLGRP)) {
+        for (CCRx = 0; CCRx < driver->_available_handles_cnt; CCRx++) {
+            if (pending & (1 << CCRx)) {
+                touched |= _compare_latch_group_mask(group, CCRx);
+            }
+        }
+    }
+
+    for (CCRx = 0, CCRn_register = driver->_CTL_register + OFS_TxCCR0; CCRx < driver->_available_handles_cnt;
+            CCRx++, CCRn_register += 2) {
+
+        handle = ((Timer_channel_handle_t **) &driver->_CCR0_handle)[CCRx];
+
+        if ((pending & (1 << CCRx)) && handle) {
+            hw_register_16(CCRn_register) = handle->_compare_staged;
+        }
+        else if (touched & (1 << CCRx)) {
+            hw_register_16(CCRn_register) = hw_register_16(CCRn_register);
+        }
+    }
+
+    driver->_compare_latch_pending = 0;
+}
+
+/**
+ * Compare latch emulation - staged values are applied on timer overflow (counter reaches 0)
+ */
+static void _compare_latch_emulation_handler(Timer_driver_t *driver) {
+    _compare_latch_apply(driver);
+    // single load event per commit
+    vector_set_enabled(driver->_compare_latch_handle, false);
+}
+
+static uint8_t _set_compare_latch(Timer_driver_t *_this, uint16_t load_mode, uint16_t group, Timer_channel_handle_t *overflow_handle) {
+    uint8_t CCRx;
+    uint16_t CCTLn_register;
+
+    // check whether driver is not disposed already
+    if ( ! _this->_CTL_register) {
+        return TIMER_DRIVER_NOT_REGISTERED;
+    }
+
+    if (_this->_compare_latch) {
+        hw_register_16(_this->_CTL_register) = (hw_register_16(_this->_CTL_register) & ~TBCLGRP) | group;
+
+        // load event of every CCRn, including those that are not registered yet
+        for (CCRx = 0, CCTLn_register = _this->_CTL_register + OFS_TxCCTL0; CCRx < _this->_available_handles_cnt;
+                CCRx++, CCTLn_register += 2) {
+
+            hw_register_16(CCTLn_register) = (hw_register_16(CCTLn_register) & ~CLLD) | load_mode;
+        }
     }
+    else if (load_mode != CLLD_0 && ! _this->_compare_latch_handle) {
+        if ( ! overflow_handle || overflow_handle->_driver != _this || overflow_handle->handle_type != OVERFLOW) {
+            return TIMER_REFUSED;
+        }
+
+        if ( ! vector_register_handler(overflow_handle, _compare_latch_emulation_handler, _this, NULL)) {
+            return TIMER_NO_HANDLE_AVAILABLE;
+        }
+
+        // overflow interrupt enabled on commit only
+        vector_set_enabled(overflow_handle, false);
+
+        _this->_compare_latch_handle = overflow_handle;
+    }
+
+    _this->_compare_latch_load_mode = load_mode;
 
     return TIMER_OK;
 }
 
+static uint8_t _compare_latch_commit(Timer_driver_t *_this) {
+
+    interrupt_suspend();
+
+    // Timer_B latches are loaded by hardware, all CCRn of group together
+    if (_this->_compare_latch || _this->_compare_latch_load_mode == CLLD_0) {
+        _compare_latch_apply(_this);
+    }
+    // emulation - staged values are applied on next overflow
+    else if (_this->_compare_latch_pending) {
+        vector_clear_interrupt_flag(_this->_compare_latch_handle);
+        vector_set_enabled(_this->_compare_latch_handle, true);
+    }
+
+    interrupt_restore();
+
+    return TIMER_OK;
+}
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Convert count of ticks to different tick rate, saturate on overflow
+ */
+static uint16_t _ticks_rescale(uint16_t ticks, uint16_t tick_rate, uint16_t tick_rate_new) {
+    uint32_t ticks_new = ((uint32_t) ticks * tick_rate_new) / tick_rate;
+
+    return ticks_new > UINT16_MAX ? UINT16_MAX : (uint16_t) ticks_new;
+}
+
+static uint8_t _reconfigure(Timer_driver_t *_this, Timer_config_t *config, uint16_t tick_rate, uint16_t tick_rate_new) {
+    uint16_t CTL_register, counter, distance, running;
+    uint8_t CCRx;
+    bool relative;
+    Timer_channel_handle_t *handle, **handle_ref = &_this->_CCR0_handle;
+
+    interrupt_suspend();
+
+    // check whether driver is not disposed already
+    if ( ! (CTL_register = _this->_CTL_register)) {
+        interrupt_restore();
+        return TIMER_DRIVER_NOT_REGISTERED;
+    }
+
+    running = hw_register_16(CTL_register) & MC;
+
+    // timer stop, counter is stable
+    hw_register_16(CTL_register) &= ~MC;
+    counter = hw_register_16(CTL_register + OFS_TxR);
+
+    // continuous mode - compare values are deadlines relative to counter, otherwise positions within period
+    relative = _this->_mode == MC__CONTINUOUS && config->mode == MC__CONTINUOUS;
+
+    if (tick_rate && tick_rate_new && tick_rate != tick_rate_new) {
+
+        for (CCRx = 0; CCRx < _this->_available_handles_cnt; CCRx++, handle_ref++) {
+            // skip capture handles
+            if ( ! (handle = *handle_ref) || handle->capture_mode) {
+                continue;
+            }
+
+            // positions within period (CCR0, PWM duties) are rescaled regardless of pending flag
+            if ( ! relative) {
+                hw_register_16(handle->_CCRn_register) = _ticks_rescale(hw_register_16(handle->_CCRn_register), tick_rate, tick_rate_new);
+            }
+            // skip compare events that already happened
+            else if (handle->active && ! (hw_register_16(handle->_CCTLn_register) & CCIFG)) {
+                distance = _ticks_rescale(hw_register_16(handle->_CCRn_register) - counter, tick_rate, tick_rate_new);
+                // compare value equal to counter would be missed when counting resumes
+                hw_register_16(handle->_CCRn_register) = counter + (distance ? distance : 1);
+            }
+
+            handle->_period = _ticks_rescale(handle->_period, tick_rate, tick_rate_new);
+        }
+
+        if ( ! relative) {
+            counter = _ticks_rescale(counter, tick_rate, tick_rate_new);
+        }
+    }
+
+    // clock source - divider, clear divider logic (and counter)
+    hw_register_16(CTL_register) = (hw_register_16(CTL_register) & ~(TASSEL | ID))
+            | config->clock_source | config->clock_source_divider | TACLR;
+#ifdef _TIMER_HAS_IDEX_
+    // input divider expansion
+    hw_register_16(CTL_register + OFS_TxEX0) = config->clock_source_divider_expansion;
+#endif
+    // restore counter
+    hw_register_16(CTL_register + OFS_TxR) = counter;
+
+    _this->_mode = config->mode;
+
+    // resume counting in new mode
+    if (running) {
+        hw_register_16(CTL_register) |= _this->_mode;
+    }
+
+    interrupt_restore();
+
+    return TIMER_OK;
+}
+
+// -------------------------------------------------------------------------------------
+
+uint32_t timer_channel_counter_extend(Timer_channel_handle_t *handle, volatile uint16_t *overflow_cnt) {
+    uint16_t counter, high;
+
+    interrupt_suspend();
+
+    timer_channel_get_counter(handle, &counter);
+    high = *overflow_cnt;
+
+    // timer overflow occurred before counter was read, overflow interrupt not serviced yet
+    if ((hw_register_16(handle->_driver->_CTL_register) & TAIFG) && counter < 0x8000) {
+        high++;
+    }
+
+    interrupt_restore();
+
+    return ((uint32_t) high << 16) | counter;
+}
+
 // -------------------------------------------------------------------------------------
 
 // Timer_driver_t destructor
@@ -489,10 +798,14 @@ void timer_driver_register(Timer_driver_t *driver, Timer_config_t *config, uint1
     driver->_shared_vector_no = shared_vector_no;
     driver->_IV_register = base + OFS_TxIV;
     driver->_mode = config->mode;
+    driver->_compare_latch = config->compare_latch;
     driver->_available_handles_cnt = available_handles_cnt;
 
     // public
     driver->channel_handle_register = _channel_handle_register;
+    driver->reconfigure = _reconfigure;
+    driver->set_compare_latch = _set_compare_latch;
+    driver->compare_latch_commit = _compare_latch_commit;
 
     // timer stop, clear interrupt flag
     hw_register_16(driver->_CTL_register) &= ~(TASSEL | ID | MC | TAIE | TAIFG);
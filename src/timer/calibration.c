@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2018-2019 Mutant Industries ltd.
+#include <driver/timer/calibration.h>
+#include <stddef.h>
+#include <driver/interrupt.h>
+
+// -------------------------------------------------------------------------------------
+
+#if ! defined(SCS__SYNC)
+#define SCS__SYNC       (0x0800)        /* Capture synchronize */
+#endif
+
+/**
+ * Max count of polling iterations per reference clock period
+ */
+#define TIMER_CALIBRATION_POLL_LIMIT    (0xFFFF)
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _unsupported_operation() {
+    return TIMER_CALIBRATION_UNSUPPORTED_OPERATION;
+}
+
+/**
+ * Wait for reference clock edge capture, reset capture interrupt flag
+ */
+static uint8_t _capture_wait(Timer_channel_handle_t *handle) {
+    uint16_t poll_cnt = TIMER_CALIBRATION_POLL_LIMIT;
+
+    while ( ! (hw_register_16(handle->_CCTLn_register) & CCIFG)) {
+        if ( ! --poll_cnt) {
+            // reference clock not running
+            return TIMER_CALIBRATION_TIMEOUT;
+        }
+    }
+
+    vector_clear_interrupt_flag(handle);
+
+    return TIMER_CALIBRATION_OK;
+}
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Sum timer ticks of configured count of reference clock periods
+ */
+static uint8_t _ticks_count(Timer_calibration_t *_this, uint32_t *ticks) {
+    uint16_t capture_last, capture, period;
+    uint8_t result;
+
+    if ((result = _capture_wait(_this->_handle))) {
+        return result;
+    }
+
+    capture_last = timer_channel_get_capture_value(_this->_handle);
+    timer_channel_is_capture_overflow_set(_this->_handle);
+
+    for (period = 0, *ticks = 0; period < _this->_config.period_cnt; period++) {
+        if ((result = _capture_wait(_this->_handle))) {
+            return result;
+        }
+
+        capture = timer_channel_get_capture_value(_this->_handle);
+        *ticks += (uint16_t) (capture - capture_last);
+        capture_last = capture;
+    }
+
+    // capture lost, ticks of one or more periods are missing
+    if (timer_channel_is_capture_overflow_set(_this->_handle)) {
+        return TIMER_CALIBRATION_CAPTURE_OVERFLOW;
+    }
+
+    return TIMER_CALIBRATION_OK;
+}
+
+static uint8_t _measure(Timer_calibration_t *_this) {
+    uint32_t ticks, frequency;
+    uint8_t result;
+
+    if ( ! _this->_config.period_cnt || ! _this->_config.nominal_frequency) {
+        return TIMER_CALIBRATION_INVALID_CONFIG;
+    }
+
+    timer_channel_set_capture_mode(_this->_handle, CM__RISING, _this->_config.input_select, SCS__SYNC);
+
+    interrupt_suspend();
+
+    // capture flag is polled, no capture interrupt between start and disable
+    if ( ! (result = timer_channel_start(_this->_handle))) {
+        vector_set_enabled(_this->_handle, false);
+    }
+
+    interrupt_restore();
+
+    if (result) {
+        return result;
+    }
+
+    result = _ticks_count(_this, &ticks);
+
+    timer_channel_stop(_this->_handle);
+
+    if (result) {
+        return result;
+    }
+
+    // measured clock not running
+    if ( ! ticks) {
+        return TIMER_CALIBRATION_TIMEOUT;
+    }
+
+    frequency = (uint32_t) (((uint64_t) ticks * _this->_config.reference_frequency * _this->_config.clock_divider)
+            / _this->_config.period_cnt);
+
+    _this->drift = (int32_t) (frequency - _this->frequency);
+    _this->frequency = frequency;
+    _this->deviation_ppm = (int32_t) ((((int64_t) frequency - (int64_t) _this->_config.nominal_frequency) * 1000000)
+            / (int64_t) _this->_config.nominal_frequency);
+
+    return TIMER_CALIBRATION_OK;
+}
+
+// -------------------------------------------------------------------------------------
+
+uint32_t timer_calibration_ticks(Timer_calibration_t *calibration, uint32_t time_us, uint8_t clock_divider) {
+    return (uint32_t) (((uint64_t) calibration->frequency * time_us) / ((uint32_t) clock_divider * 1000000));
+}
+
+// -------------------------------------------------------------------------------------
+
+// Timer_calibration_t destructor
+static dispose_function_t _timer_calibration_dispose(Timer_calibration_t *_this) {
+
+    _this->measure = (uint8_t (*)(Timer_calibration_t *)) _unsupported_operation;
+
+    // last measured values can still be read after disposed
+
+    return NULL;
+}
+
+// Timer_calibration_t constructor
+void timer_calibration_register(Timer_calibration_t *calibration, Timer_channel_handle_t *handle, Timer_calibration_config_t *config) {
+
+    zerofill(calibration);
+
+    // private
+    calibration->_handle = handle;
+    calibration->_config = *config;
+
+    // public
+    calibration->measure = _measure;
+    calibration->frequency = config->nominal_frequency;
+
+    __dispose_hook_register(calibration, _timer_calibration_dispose);
+}
@@ -0,0 +1,313 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2018-2019 Mutant Industries ltd.
+#include <driver/timer/capture.h>
+#include <stddef.h>
+#include <driver/interrupt.h>
+
+
+// DMA controller support check {@see DMA.h}
+#ifdef __DMA_CONTROLLER_SUPPORT__
+
+// -------------------------------------------------------------------------------------
+
+#if ! defined(SCS__SYNC)
+#define SCS__SYNC       (0x0800)        /* Capture synchronize */
+#endif
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _unsupported_operation() {
+    return TIMER_CAPTURE_STREAM_UNSUPPORTED_OPERATION;
+}
+
+// -------------------------------------------------------------------------------------
+
+static void _buffer_wrap_handler(Timer_capture_stream_t *_this) {
+
+    _this->_write_wrap_cnt++;
+
+    // capture performed before DMA managed to transfer previous one
+    if (timer_channel_is_capture_overflow_set(_this->_handle)) {
+        _this->capture_overflow_event_cnt++;
+    }
+}
+
+static void _overflow_handler(Timer_capture_stream_t *_this) {
+    _this->_overflow_cnt++;
+}
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Get index of next sample to be written by DMA and corresponding count of buffer wraps
+ */
+static uint16_t _write_index(Timer_capture_stream_t *_this, uint16_t *write_wrap_cnt) {
+    uint16_t remaining, wrap_pending;
+
+    interrupt_suspend();
+
+    // DMAxSZ is reloaded and DMAIFG is set at the same time, make sure both are read consistently
+    do {
+        wrap_pending = hw_register_16(_this->_DMA_channel->_CTL_register) & DMAIFG;
+        remaining = DMA_channel_size(_this->_DMA_channel);
+    } while (wrap_pending != (hw_register_16(_this->_DMA_channel->_CTL_register) & DMAIFG));
+
+    *write_wrap_cnt = _this->_write_wrap_cnt + (wrap_pending ? 1 : 0);
+
+    interrupt_restore();
+
+    return _this->_length - remaining;
+}
+
+/**
+ * Get count of samples available to read, on circular buffer overrun skip samples that have been overwritten
+ */
+static uint16_t _sync(Timer_capture_stream_t *_this, bool *overrun) {
+    uint16_t write_index, write_wrap_cnt;
+    uint32_t available, skipped;
+
+    write_index = _write_index(_this, &write_wrap_cnt);
+
+    available = (uint32_t) ((uint16_t) (write_wrap_cnt - _this->_read_wrap_cnt)) * _this->_length
+            + write_index - _this->_read_index;
+
+    if ((*overrun = (available > _this->_length))) {
+        skipped = available - _this->_length;
+
+        _this->overrun_cnt += (uint16_t) skipped;
+
+        // oldest sample still present is the one to be overwritten next
+        _this->_read_index = write_index;
+        _this->_read_wrap_cnt = write_wrap_cnt - 1;
+
+        // keep track of edge polarity
+        if (skipped & 1) {
+            _this->_rising_edge_next = ! _this->_rising_edge_next;
+        }
+
+        available = _this->_length;
+    }
+
+    return (uint16_t) available;
+}
+
+static uint32_t _timestamp_extend(Timer_capture_stream_t *_this, uint16_t sample) {
+    uint32_t now;
+
+    if ( ! _this->_overflow_handle) {
+        // consecutive samples are less than one timer period apart
+        return _this->_timestamp_last += (uint16_t) (sample - (uint16_t) _this->_timestamp_last);
+    }
+
+    now = timer_channel_counter_extend(_this->_handle, &_this->_overflow_cnt);
+
+    // sample captured before the last overflow
+    return (now & 0xFFFF0000) - (sample > (uint16_t) now ? 0x10000 : 0) + sample;
+}
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _start(Timer_capture_stream_t *_this, uint16_t mode, uint16_t input_select) {
+
+    if (_this->active) {
+        return TIMER_CAPTURE_STREAM_ACTIVE;
+    }
+
+    _this->_capture_mode = mode;
+    _this->_read_index = 0;
+    _this->_read_wrap_cnt = 0;
+    _this->_write_wrap_cnt = 0;
+    _this->_overflow_cnt = 0;
+    _this->_timestamp_last = 0;
+
+    // DMA channel is disabled by trigger select, CCRn source, destination incremented, repeated over circular buffer
+    DMA_channel_select_trigger(_this->_DMA_channel, _this->_DMA_trigger);
+    DMA_channel_set_control(_this->_DMA_channel, DMALEVEL__EDGE, DMASRCBYTE__WORD, DMADSTBYTE__WORD,
+            DMASRCINCR_0, DMADSTINCR_3, DMADT_4);
+
+    DMA_channel_source_address(_this->_DMA_channel) = (void *) _this->_handle->_CCRn_register;
+    DMA_channel_destination_address(_this->_DMA_channel) = _this->_buffer;
+    DMA_channel_size(_this->_DMA_channel) = _this->_length;
+
+    // one interrupt per buffer wrap
+    vector_clear_interrupt_flag(_this->_DMA_channel);
+    vector_set_enabled(_this->_DMA_channel, true);
+
+    DMA_channel_set_enabled(_this->_DMA_channel, true);
+
+    timer_channel_set_capture_mode(_this->_handle, mode, input_select, SCS__SYNC);
+    timer_channel_is_capture_overflow_set(_this->_handle);
+
+    // next edge is the opposite of current input level
+    _this->_rising_edge_next = ! (hw_register_16(_this->_handle->_CCTLn_register) & CCI);
+
+    if (_this->_overflow_handle) {
+        timer_channel_start(_this->_overflow_handle);
+    }
+
+    interrupt_suspend();
+
+    timer_channel_start(_this->_handle);
+    // DMA is triggered by CCIFG, capture interrupt is not used
+    vector_set_enabled(_this->_handle, false);
+
+    interrupt_restore();
+
+    _this->active = true;
+
+    return TIMER_CAPTURE_STREAM_OK;
+}
+
+static uint8_t _stop(Timer_capture_stream_t *_this) {
+
+    timer_channel_stop(_this->_handle);
+
+    if (_this->_overflow_handle) {
+        timer_channel_stop(_this->_overflow_handle);
+    }
+
+    DMA_channel_set_enabled(_this->_DMA_channel, false);
+    vector_set_enabled(_this->_DMA_channel, false);
+
+    _this->active = false;
+
+    return TIMER_CAPTURE_STREAM_OK;
+}
+
+static uint16_t _available(Timer_capture_stream_t *_this) {
+    bool overrun;
+
+    return _sync(_this, &overrun);
+}
+
+static uint8_t _read(Timer_capture_stream_t *_this, uint32_t *timestamp) {
+    uint16_t sample;
+    bool overrun;
+
+    if ( ! _sync(_this, &overrun)) {
+        return TIMER_CAPTURE_STREAM_EMPTY;
+    }
+
+    sample = _this->_buffer[_this->_read_index];
+
+    if (++_this->_read_index == _this->_length) {
+        _this->_read_index = 0;
+        _this->_read_wrap_cnt++;
+    }
+
+    if (_this->_capture_mode == CM__BOTH) {
+        _this->_rising_edge_next = ! _this->_rising_edge_next;
+    }
+
+    *timestamp = _timestamp_extend(_this, sample);
+
+    // sample is valid, however it does not follow previously read one
+    return overrun ? TIMER_CAPTURE_STREAM_OVERRUN : TIMER_CAPTURE_STREAM_OK;
+}
+
+static uint8_t _measure(Timer_capture_stream_t *_this, Timer_capture_measurement_t *measurement) {
+    uint32_t timestamp, timestamp_last = 0, high_sum = 0, low_sum = 0;
+    uint16_t high_cnt = 0, low_cnt = 0;
+    uint8_t read_result, result = TIMER_CAPTURE_STREAM_OK;
+    bool rising_edge;
+
+    measurement->sample_cnt = 0;
+    measurement->period = 0;
+    measurement->pulse_width = 0;
+
+    while (true) {
+        rising_edge = _this->_rising_edge_next;
+
+        if ((read_result = _read(_this, &timestamp)) == TIMER_CAPTURE_STREAM_EMPTY) {
+            break;
+        }
+
+        // discard samples preceding overrun
+        if (read_result == TIMER_CAPTURE_STREAM_OVERRUN) {
+            result = TIMER_CAPTURE_STREAM_OVERRUN;
+            measurement->sample_cnt = 0;
+            high_sum = low_sum = 0;
+            high_cnt = low_cnt = 0;
+        }
+
+        if (measurement->sample_cnt) {
+            // single edge capture - every interval is a whole period, accumulated as high time
+            if (_this->_capture_mode != CM__BOTH || ! rising_edge) {
+                high_sum += timestamp - timestamp_last;
+                high_cnt++;
+            }
+            else {
+                low_sum += timestamp - timestamp_last;
+                low_cnt++;
+            }
+        }
+
+        timestamp_last = timestamp;
+        measurement->sample_cnt++;
+    }
+
+    if (_this->_capture_mode != CM__BOTH) {
+        if (high_cnt) {
+            measurement->period = high_sum / high_cnt;
+        }
+    }
+    else if (high_cnt && low_cnt) {
+        measurement->pulse_width = high_sum / high_cnt;
+        measurement->period = measurement->pulse_width + low_sum / low_cnt;
+    }
+
+    return measurement->sample_cnt ? result : TIMER_CAPTURE_STREAM_EMPTY;
+}
+
+// -------------------------------------------------------------------------------------
+
+// Timer_capture_stream_t destructor
+static dispose_function_t _timer_capture_stream_dispose(Timer_capture_stream_t *_this) {
+
+    _this->stop(_this);
+
+    _this->start = (uint8_t (*)(Timer_capture_stream_t *, uint16_t, uint16_t)) _unsupported_operation;
+    _this->stop = (uint8_t (*)(Timer_capture_stream_t *)) _unsupported_operation;
+
+    // samples already captured can still be read after disposed
+
+    return NULL;
+}
+
+// Timer_capture_stream_t constructor
+uint8_t timer_capture_stream_register(Timer_capture_stream_t *stream, Timer_channel_handle_t *handle, Timer_channel_handle_t *overflow_handle,
+        DMA_channel_handle_t *DMA_channel, uint16_t DMA_trigger, uint16_t *buffer, uint16_t length) {
+
+    zerofill(stream);
+
+    // private
+    stream->_handle = handle;
+    stream->_overflow_handle = overflow_handle;
+    stream->_DMA_channel = DMA_channel;
+    stream->_DMA_trigger = DMA_trigger;
+    stream->_buffer = buffer;
+    stream->_length = length;
+
+    if ( ! vector_register_handler(DMA_channel, _buffer_wrap_handler, stream, NULL)) {
+        return TIMER_CAPTURE_STREAM_VECTOR_SLOT_UNAVAILABLE;
+    }
+
+    vector_set_enabled(DMA_channel, false);
+
+    if (overflow_handle && ! vector_register_handler(overflow_handle, _overflow_handler, stream, NULL)) {
+        return TIMER_CAPTURE_STREAM_VECTOR_SLOT_UNAVAILABLE;
+    }
+
+    // public
+    stream->start = _start;
+    stream->stop = _stop;
+    stream->available = _available;
+    stream->read = _read;
+    stream->measure = _measure;
+
+    __dispose_hook_register(stream, _timer_capture_stream_dispose);
+
+    return TIMER_CAPTURE_STREAM_OK;
+}
+
+#endif /* DMA controller support check */
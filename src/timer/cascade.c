@@ -0,0 +1,235 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2018-2019 Mutant Industries ltd.
+#include <driver/timer/cascade.h>
+#include <stddef.h>
+#include <driver/interrupt.h>
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Low timer counter range after overflow, in which carry might not have reached high timer yet
+ */
+#define TIMER_CASCADE_CARRY_WINDOW      (2)
+
+/**
+ * Carry handle compare value - output is set on CCR0 (low timer overflow), reset in the middle of low timer period
+ */
+#define TIMER_CASCADE_CARRY_RESET       (0x8000)
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _unsupported_operation() {
+    return TIMER_CASCADE_UNSUPPORTED_OPERATION;
+}
+
+/**
+ * Switch handle to compare mode with given output mode and compare value, disable compare interrupt and start
+ */
+static void _channel_start(Timer_channel_handle_t *handle, uint16_t output_mode, uint16_t compare_value) {
+    timer_channel_set_compare_mode(handle, output_mode);
+    timer_channel_set_compare_value(handle, compare_value);
+    vector_set_enabled(handle, false);
+    timer_channel_start(handle);
+}
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _get_counter(Timer_cascade_t *_this, uint32_t *target) {
+    uint16_t high, high_check, low;
+    uint8_t result;
+
+    do {
+        if ((result = timer_channel_get_counter(_this->_high_handle, &high))
+                || (result = timer_channel_get_counter(_this->_low_main_handle, &low))
+                || (result = timer_channel_get_counter(_this->_high_handle, &high_check))) {
+
+            return result;
+        }
+    // repeat if carry occurred during read or if it might not have reached high timer yet
+    } while (high != high_check || (_this->active && low < TIMER_CASCADE_CARRY_WINDOW));
+
+    *target = ((uint32_t) high << 16) | low;
+
+    return TIMER_CASCADE_OK;
+}
+
+/**
+ * Second stage of compare - high word of compare value reached, arm low compare handle
+ */
+static void _low_compare_arm(Timer_cascade_t *_this) {
+    uint32_t counter;
+
+    vector_set_enabled(_this->_high_handle, false);
+
+    timer_channel_set_compare_value(_this->_low_compare_handle, (uint16_t) _this->_compare_value);
+    vector_clear_interrupt_flag(_this->_low_compare_handle);
+
+    _get_counter(_this, &counter);
+
+    // compare value passed already
+    if ((int32_t) (counter - _this->_compare_value) >= 0) {
+        vector_trigger(_this->_low_compare_handle);
+    }
+
+    // flag set by hardware after cleared shall trigger interrupt right after enabled
+    vector_set_enabled(_this->_low_compare_handle, true);
+}
+
+static void _high_compare_handler(Timer_cascade_t *_this) {
+    _low_compare_arm(_this);
+}
+
+static void _low_compare_handler(Timer_cascade_t *_this) {
+
+    vector_set_enabled(_this->_low_compare_handle, false);
+
+    if (_this->_on_compare) {
+        _this->_on_compare(_this->_owner, _this->_event_arg);
+    }
+}
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _set_compare_value(Timer_cascade_t *_this, uint32_t value) {
+    uint32_t counter;
+
+    if ( ! _this->active) {
+        return TIMER_CASCADE_NOT_ACTIVE;
+    }
+
+    interrupt_suspend();
+
+    vector_set_enabled(_this->_low_compare_handle, false);
+
+    _this->_compare_value = value;
+
+    // first stage - high timer reaches high word of compare value
+    timer_channel_set_compare_value(_this->_high_handle, (uint16_t) (value >> 16));
+    vector_clear_interrupt_flag(_this->_high_handle);
+
+    _get_counter(_this, &counter);
+
+    // high word of compare value reached already
+    if ((int16_t) ((uint16_t) (counter >> 16) - (uint16_t) (value >> 16)) >= 0) {
+        _low_compare_arm(_this);
+    }
+    else {
+        vector_set_enabled(_this->_high_handle, true);
+    }
+
+    interrupt_restore();
+
+    return TIMER_CASCADE_OK;
+}
+
+static uint8_t _compare_cancel(Timer_cascade_t *_this) {
+
+    interrupt_suspend();
+
+    vector_set_enabled(_this->_high_handle, false);
+    vector_set_enabled(_this->_low_compare_handle, false);
+
+    interrupt_restore();
+
+    return TIMER_CASCADE_OK;
+}
+
+static uint8_t _start(Timer_cascade_t *_this) {
+    uint8_t result;
+
+    timer_channel_set_compare_mode(_this->_high_handle, OUTMOD_0);
+    vector_set_enabled(_this->_high_handle, false);
+
+    // high timer first, so that no carry is lost
+    if ((result = timer_channel_start(_this->_high_handle))) {
+        return result;
+    }
+
+    // low timer overflow sets carry output, high timer counts on rising edge
+    _channel_start(_this->_low_main_handle, OUTMOD_0, 0);
+    _channel_start(_this->_carry_handle, OUTMOD_7, TIMER_CASCADE_CARRY_RESET);
+
+    if (_this->_low_compare_handle) {
+        _channel_start(_this->_low_compare_handle, OUTMOD_0, 0);
+    }
+
+    _this->active = true;
+
+    return TIMER_CASCADE_OK;
+}
+
+static uint8_t _stop(Timer_cascade_t *_this) {
+
+    _this->active = false;
+
+    if (_this->_low_compare_handle) {
+        timer_channel_stop(_this->_low_compare_handle);
+    }
+
+    timer_channel_stop(_this->_carry_handle);
+    timer_channel_stop(_this->_low_main_handle);
+    timer_channel_stop(_this->_high_handle);
+
+    return TIMER_CASCADE_OK;
+}
+
+// -------------------------------------------------------------------------------------
+
+// Timer_cascade_t destructor
+static dispose_function_t _timer_cascade_dispose(Timer_cascade_t *_this) {
+
+    _this->stop(_this);
+
+    _this->_on_compare = NULL;
+
+    _this->start = (uint8_t (*)(Timer_cascade_t *)) _unsupported_operation;
+    _this->stop = (uint8_t (*)(Timer_cascade_t *)) _unsupported_operation;
+    _this->set_compare_value = (uint8_t (*)(Timer_cascade_t *, uint32_t)) _unsupported_operation;
+    _this->compare_cancel = (uint8_t (*)(Timer_cascade_t *)) _unsupported_operation;
+
+    // counter can still be read after disposed
+
+    return NULL;
+}
+
+// Timer_cascade_t constructor
+uint8_t timer_cascade_register(Timer_cascade_t *cascade, Timer_channel_handle_t *low_main_handle, Timer_channel_handle_t *carry_handle,
+        Timer_channel_handle_t *low_compare_handle, Timer_channel_handle_t *high_handle) {
+
+    zerofill(cascade);
+
+    // private
+    cascade->_low_main_handle = low_main_handle;
+    cascade->_carry_handle = carry_handle;
+    cascade->_low_compare_handle = low_compare_handle;
+    cascade->_high_handle = high_handle;
+    cascade->_owner = cascade;
+
+    // public
+    cascade->start = _start;
+    cascade->stop = _stop;
+    cascade->get_counter = _get_counter;
+
+    if (low_compare_handle) {
+        if ( ! vector_register_handler(high_handle, _high_compare_handler, cascade, NULL)) {
+            return TIMER_CASCADE_VECTOR_SLOT_UNAVAILABLE;
+        }
+
+        if ( ! vector_register_handler(low_compare_handle, _low_compare_handler, cascade, NULL)) {
+            vector_release_handler(high_handle);
+
+            return TIMER_CASCADE_VECTOR_SLOT_UNAVAILABLE;
+        }
+
+        cascade->set_compare_value = _set_compare_value;
+        cascade->compare_cancel = _compare_cancel;
+    }
+    else {
+        cascade->set_compare_value = (uint8_t (*)(Timer_cascade_t *, uint32_t)) _unsupported_operation;
+        cascade->compare_cancel = (uint8_t (*)(Timer_cascade_t *)) _unsupported_operation;
+    }
+
+    __dispose_hook_register(cascade, _timer_cascade_dispose);
+
+    return TIMER_CASCADE_OK;
+}
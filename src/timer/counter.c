@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2018-2019 Mutant Industries ltd.
+#include <driver/timer/counter.h>
+#include <stddef.h>
+#include <driver/interrupt.h>
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _unsupported_operation() {
+    return TIMER_COUNTER_UNSUPPORTED_OPERATION;
+}
+
+/**
+ * Read counter extended by overflow count, overflow not serviced yet is accounted for
+ */
+static uint32_t _count_read(Timer_counter_t *_this) {
+    return timer_channel_counter_extend(_this->_handle, &_this->_overflow_cnt);
+}
+
+// -------------------------------------------------------------------------------------
+
+static void _overflow_handler(Timer_counter_t *_this) {
+    _this->_overflow_cnt++;
+}
+
+static void _gate_handler(Timer_counter_t *_this) {
+    uint32_t count = _count_read(_this);
+
+    hw_register_16(_this->_gate_handle->_CCRn_register) += _this->_window_ticks;
+
+    if ( ! _this->_window_index++) {
+        _this->_window_start = count;
+
+        return;
+    }
+
+    if (_this->_window_index <= _this->_window_cnt) {
+        return;
+    }
+
+    timer_channel_stop(_this->_gate_handle);
+    vector_set_enabled(_this->_gate_handle, false);
+
+    _this->window_pulse_cnt = count - _this->_window_start;
+    _this->measuring = false;
+
+    if (_this->_on_measurement) {
+        _this->_on_measurement(_this->_owner, _this->_event_arg);
+    }
+}
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _start(Timer_counter_t *_this) {
+    uint8_t result;
+
+    if (_this->active) {
+        return TIMER_COUNTER_ACTIVE;
+    }
+
+    interrupt_suspend();
+
+    _this->_overflow_cnt = 0;
+
+    if ( ! (result = timer_channel_start(_this->_handle))) {
+        // counting timer might have been started by other handles already
+        _this->_count_base = _count_read(_this);
+        _this->active = true;
+    }
+
+    interrupt_restore();
+
+    return result;
+}
+
+static uint8_t _stop(Timer_counter_t *_this) {
+
+    if (_this->_gate_handle) {
+        timer_channel_stop(_this->_gate_handle);
+        vector_set_enabled(_this->_gate_handle, false);
+    }
+
+    timer_channel_stop(_this->_handle);
+
+    _this->measuring = false;
+    _this->active = false;
+
+    return TIMER_COUNTER_OK;
+}
+
+static uint8_t _get_count(Timer_counter_t *_this, uint32_t *target) {
+
+    if ( ! _this->active) {
+        return TIMER_COUNTER_NOT_ACTIVE;
+    }
+
+    *target = _count_read(_this) - _this->_count_base;
+
+    return TIMER_COUNTER_OK;
+}
+
+static uint8_t _measure(Timer_counter_t *_this, uint16_t window_ticks, uint16_t window_cnt) {
+    uint16_t counter;
+    uint8_t result;
+
+    if ( ! _this->active) {
+        return TIMER_COUNTER_NOT_ACTIVE;
+    }
+
+    if (_this->measuring) {
+        return TIMER_COUNTER_ACTIVE;
+    }
+
+    if ( ! window_ticks) {
+        return TIMER_COUNTER_INVALID_WINDOW;
+    }
+
+    _this->_window_ticks = window_ticks;
+    _this->_window_cnt = window_cnt ? window_cnt : 1;
+    _this->_window_index = 0;
+
+    timer_channel_set_compare_mode(_this->_gate_handle, OUTMOD_0);
+
+    interrupt_suspend();
+
+    if ( ! (result = timer_channel_start(_this->_gate_handle))) {
+        // window starts on first compare event, so that both snapshots have the same interrupt latency
+        timer_channel_get_counter(_this->_gate_handle, &counter);
+        hw_register_16(_this->_gate_handle->_CCRn_register) = counter + window_ticks;
+        vector_clear_interrupt_flag(_this->_gate_handle);
+
+        _this->measuring = true;
+    }
+
+    interrupt_restore();
+
+    return result;
+}
+
+// -------------------------------------------------------------------------------------
+
+uint32_t timer_counter_frequency(Timer_counter_t *counter, uint32_t gate_frequency) {
+
+    // no window measured yet
+    if ( ! counter->_window_ticks) {
+        return 0;
+    }
+
+    return (uint32_t) (((uint64_t) counter->window_pulse_cnt * gate_frequency)
+            / ((uint32_t) counter->_window_ticks * counter->_window_cnt));
+}
+
+// -------------------------------------------------------------------------------------
+
+// Timer_counter_t destructor
+static dispose_function_t _timer_counter_dispose(Timer_counter_t *_this) {
+
+    _this->stop(_this);
+
+    _this->_on_measurement = NULL;
+
+    _this->start = (uint8_t (*)(Timer_counter_t *)) _unsupported_operation;
+    _this->stop = (uint8_t (*)(Timer_counter_t *)) _unsupported_operation;
+    _this->get_count = (uint8_t (*)(Timer_counter_t *, uint32_t *)) _unsupported_operation;
+    _this->measure = (uint8_t (*)(Timer_counter_t *, uint16_t, uint16_t)) _unsupported_operation;
+
+    // last measured window can still be read after disposed
+
+    return NULL;
+}
+
+// Timer_counter_t constructor
+uint8_t timer_counter_register(Timer_counter_t *counter, Timer_channel_handle_t *overflow_handle, Timer_channel_handle_t *gate_handle) {
+
+    zerofill(counter);
+
+    // private
+    counter->_handle = overflow_handle;
+    counter->_gate_handle = gate_handle;
+    counter->_owner = counter;
+
+    if ( ! vector_register_handler(overflow_handle, _overflow_handler, counter, NULL)) {
+        return TIMER_COUNTER_VECTOR_SLOT_UNAVAILABLE;
+    }
+
+    if (gate_handle && ! vector_register_handler(gate_handle, _gate_handler, counter, NULL)) {
+        vector_release_handler(overflow_handle);
+
+        return TIMER_COUNTER_VECTOR_SLOT_UNAVAILABLE;
+    }
+
+    // public
+    counter->start = _start;
+    counter->stop = _stop;
+    counter->get_count = _get_count;
+    counter->measure = gate_handle ? _measure : (uint8_t (*)(Timer_counter_t *, uint16_t, uint16_t)) _unsupported_operation;
+
+    __dispose_hook_register(counter, _timer_counter_dispose);
+
+    return TIMER_COUNTER_OK;
+}
@@ -0,0 +1,240 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2018-2019 Mutant Industries ltd.
+#include <driver/timer/delay.h>
+#include <stddef.h>
+#include <compiler.h>
+#include <driver/interrupt.h>
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Count of cycle loop iterations the loop calibration is based on
+ */
+#define TIMER_DELAY_LOOP_CALIBRATION_CNT    (2048)
+
+/**
+ * Delay used for wake latency calibration [us], shortest of runs is taken
+ */
+#define TIMER_DELAY_WAKE_CALIBRATION_US     (500)
+#define TIMER_DELAY_WAKE_CALIBRATION_CNT    (4)
+
+/**
+ * Min distance of compare value from counter, closer compare value might be missed
+ */
+#define TIMER_DELAY_ARM_MARGIN              (4)
+
+/**
+ * Max ticks slept at once, longer delays are split
+ */
+#define TIMER_DELAY_CHUNK                   (0x4000)
+
+// -------------------------------------------------------------------------------------
+
+// registered service - the raw compare interrupt handler takes no argument, so only one service can exist
+static Timer_delay_t *_instance;
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _unsupported_operation() {
+    return TIMER_DELAY_UNSUPPORTED_OPERATION;
+}
+
+/**
+ * Compare event - wake up the CPU
+ */
+static __interrupt void _compare_interrupt_handler() {
+    // single compare event per sleep
+    vector_set_enabled(_instance->_handle, false);
+
+    _instance->_expired = true;
+
+    __bic_SR_register_on_exit(LPM4_bits);
+}
+
+static void _cycle_loop(uint16_t iteration_cnt) {
+    while (iteration_cnt--) {
+        __no_operation();
+    }
+}
+
+static uint32_t _us_to_ticks(Timer_delay_t *_this, uint32_t time_us) {
+    return (uint32_t) (((uint64_t) time_us * _this->_config.timer_frequency) / 1000000);
+}
+
+/**
+ * Sleep until compare event, return counter right after wake-up
+ */
+static uint16_t _sleep(Timer_delay_t *_this, uint16_t compare_value) {
+    uint16_t counter;
+
+    _this->_expired = false;
+
+    interrupt_suspend();
+
+    timer_channel_set_compare_value(_this->_handle, compare_value);
+    vector_clear_interrupt_flag(_this->_handle);
+
+    timer_channel_get_counter(_this->_handle, &counter);
+
+    // compare value passed already or too close
+    if ((int16_t) (compare_value - counter) <= TIMER_DELAY_ARM_MARGIN) {
+        interrupt_restore();
+
+        return counter;
+    }
+
+    vector_set_enabled(_this->_handle, true);
+
+    // woken up by other interrupt
+    while ( ! _this->_expired) {
+        // interrupt enable and LPM entry in single instruction, no wake-up is lost
+        __bis_SR_register(_this->_config.low_power_mode | GIE);
+        interrupt_disable();
+    }
+
+    timer_channel_get_counter(_this->_handle, &counter);
+
+    interrupt_restore();
+
+    return counter;
+}
+
+// -------------------------------------------------------------------------------------
+
+static uint16_t _timestamp(Timer_delay_t *_this) {
+    uint16_t counter;
+
+    timer_channel_get_counter(_this->_handle, &counter);
+
+    return counter;
+}
+
+static void _sleep_until(Timer_delay_t *_this, uint16_t timestamp) {
+    uint16_t counter;
+
+    counter = _sleep(_this, timestamp - _this->wake_latency);
+
+    // remaining ticks when wake latency is overestimated or deadline too close to sleep
+    while ((int16_t) (counter - timestamp) < 0) {
+        timer_channel_get_counter(_this->_handle, &counter);
+    }
+}
+
+static void _delay_us(Timer_delay_t *_this, uint32_t time_us) {
+    uint16_t deadline;
+    uint32_t ticks;
+
+    if (time_us < _this->threshold_us) {
+        _cycle_loop((uint16_t) ((time_us * _this->_loop_iterations_q8) >> 8));
+
+        return;
+    }
+
+    deadline = _timestamp(_this);
+
+    for (ticks = _us_to_ticks(_this, time_us); ticks > TIMER_DELAY_CHUNK; ticks -= TIMER_DELAY_CHUNK) {
+        _sleep_until(_this, deadline += TIMER_DELAY_CHUNK);
+    }
+
+    _sleep_until(_this, deadline + (uint16_t) ticks);
+}
+
+static uint8_t _calibrate(Timer_delay_t *_this) {
+    uint16_t start, stop, latency, compare_value;
+    uint8_t run;
+
+    if ( ! _this->_config.timer_frequency) {
+        return TIMER_DELAY_CALIBRATION_FAILED;
+    }
+
+    // cycle loop duration
+    interrupt_suspend();
+
+    start = _timestamp(_this);
+    _cycle_loop(TIMER_DELAY_LOOP_CALIBRATION_CNT);
+    stop = _timestamp(_this);
+
+    interrupt_restore();
+
+    // timer not running or too slow to measure the loop
+    if (stop == start) {
+        return TIMER_DELAY_CALIBRATION_FAILED;
+    }
+
+    _this->_loop_iterations_q8 = (uint16_t) ((((uint64_t) TIMER_DELAY_LOOP_CALIBRATION_CNT << 8) * _this->_config.timer_frequency)
+            / ((uint64_t) (uint16_t) (stop - start) * 1000000));
+
+    // wake latency - time from compare event to CPU running again
+    for (run = 0, _this->wake_latency = UINT16_MAX; run < TIMER_DELAY_WAKE_CALIBRATION_CNT; run++) {
+        compare_value = _timestamp(_this) + (uint16_t) _us_to_ticks(_this, TIMER_DELAY_WAKE_CALIBRATION_US);
+
+        if ((latency = _sleep(_this, compare_value) - compare_value) < _this->wake_latency) {
+            _this->wake_latency = latency;
+        }
+    }
+
+    // sleep pays off only when delay is longer than twice the overhead
+    _this->threshold_us = _this->_config.threshold_us ? _this->_config.threshold_us
+            : (uint16_t) (((uint32_t) _this->wake_latency * 2 * 1000000) / _this->_config.timer_frequency + 1);
+
+    return TIMER_DELAY_OK;
+}
+
+// -------------------------------------------------------------------------------------
+
+// Timer_delay_t destructor
+static dispose_function_t _timer_delay_dispose(Timer_delay_t *_this) {
+
+    vector_set_enabled(_this->_handle, false);
+    timer_channel_stop(_this->_handle);
+
+    _this->delay_us = (void (*)(Timer_delay_t *, uint32_t)) _unsupported_operation;
+    _this->sleep_until = (void (*)(Timer_delay_t *, uint16_t)) _unsupported_operation;
+    _this->calibrate = (uint8_t (*)(Timer_delay_t *)) _unsupported_operation;
+
+    _instance = NULL;
+
+    return NULL;
+}
+
+// Timer_delay_t constructor
+uint8_t timer_delay_register(Timer_delay_t *delay, Timer_channel_handle_t *handle, Timer_delay_config_t *config) {
+    uint8_t result;
+
+    zerofill(delay);
+
+    if (handle->handle_type != MAIN) {
+        return TIMER_DELAY_INVALID_HANDLE;
+    }
+
+    if (_instance) {
+        return TIMER_DELAY_ALREADY_REGISTERED;
+    }
+
+    // private
+    delay->_handle = handle;
+    delay->_config = *config;
+
+    if ((result = vector_register_raw_handler(handle, _compare_interrupt_handler, true))) {
+        return result;
+    }
+
+    timer_channel_set_compare_mode(handle, OUTMOD_0);
+    vector_set_enabled(handle, false);
+
+    if ((result = timer_channel_start(handle))) {
+        return result;
+    }
+
+    // public
+    delay->delay_us = _delay_us;
+    delay->sleep_until = _sleep_until;
+    delay->timestamp = _timestamp;
+    delay->calibrate = _calibrate;
+
+    _instance = delay;
+
+    __dispose_hook_register(delay, _timer_delay_dispose);
+
+    return _calibrate(delay);
+}
@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2018-2019 Mutant Industries ltd.
+#include <driver/timer/group.h>
+#include <stddef.h>
+#include <driver/interrupt.h>
+
+// -------------------------------------------------------------------------------------
+
+#if ! defined(MC)
+#define MC              (0x0030)        /* Mode control */
+#endif
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _unsupported_operation() {
+    return TIMER_GROUP_UNSUPPORTED_OPERATION;
+}
+
+/**
+ * Counter period of timer - CCR0 + 1 in MC__UP, 0x10000 in MC__CONTINUOUS
+ */
+static uint32_t _period_get(Timer_driver_t *driver) {
+
+    if ((driver->_mode & MC) == MC__UP) {
+        return (uint32_t) hw_register_16(driver->_CTL_register + OFS_TxCCR0) + 1;
+    }
+
+    return 0x10000;
+}
+
+/**
+ * Reduce position modulo given period
+ */
+static int32_t _position_reduce(int32_t position, uint32_t period) {
+
+    if ((position %= (int32_t) period) < 0) {
+        position += period;
+    }
+
+    return position;
+}
+
+/**
+ * Lag of member behind reference member, reference counter is interpolated to the time member counter is read
+ *  - each counter is reduced modulo period of its own timer, lag is reduced to (-period / 2, period / 2] of member
+ * timer, so that counter wrap between reads is not counted as lag
+ */
+static int16_t _lag_measure(Timer_group_member_t *reference, Timer_group_member_t *member) {
+    uint16_t reference_TxR_register, member_TxR_register;
+    uint16_t before, counter, after;
+    uint32_t reference_period, period;
+    int32_t elapsed, lag;
+
+    reference_TxR_register = reference->handle->_driver->_CTL_register + OFS_TxR;
+    member_TxR_register = member->handle->_driver->_CTL_register + OFS_TxR;
+
+    before = hw_register_16(reference_TxR_register);
+    counter = hw_register_16(member_TxR_register);
+    after = hw_register_16(reference_TxR_register);
+
+    reference_period = _period_get(reference->handle->_driver);
+    period = _period_get(member->handle->_driver);
+
+    // reference wrapped between reads
+    elapsed = _position_reduce((int32_t) after - before, reference_period);
+
+    lag = _position_reduce((int32_t) before + elapsed / 2 - reference->phase, reference_period)
+            - ((int32_t) counter - member->phase);
+
+    lag = _position_reduce(lag, period);
+
+    if ((uint32_t) lag > period / 2) {
+        lag -= period;
+    }
+
+    return (int16_t) lag;
+}
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _start(Timer_group_t *_this) {
+    uint16_t CTL_register[TIMER_GROUP_MEMBER_MAX], CTL_value[TIMER_GROUP_MEMBER_MAX];
+    Timer_group_member_t *member;
+    uint8_t index, result;
+
+    if (_this->active) {
+        return TIMER_GROUP_ACTIVE;
+    }
+
+    interrupt_suspend();
+
+    for (index = 0; index < _this->_member_cnt; index++) {
+        member = &_this->_members[index];
+
+        if ((result = timer_channel_start(member->handle))) {
+            // roll back members started already, resume halted timers so that other handles keep running
+            while (index--) {
+                hw_register_16(CTL_register[index]) = CTL_value[index];
+                timer_channel_stop(_this->_members[index].handle);
+            }
+
+            interrupt_restore();
+
+            return result;
+        }
+
+        // timer is started by first active handle, halt it until all members are preloaded
+        CTL_register[index] = member->handle->_driver->_CTL_register;
+        hw_register_16(CTL_register[index]) &= ~MC;
+        CTL_value[index] = hw_register_16(CTL_register[index]) | member->handle->_driver->_mode;
+
+        // compare value first, it might be CCR0 that defines period
+        timer_channel_set_compare_value(member->handle, member->compare_value);
+        hw_register_16(CTL_register[index] + OFS_TxR) = (uint16_t) _position_reduce(member->phase,
+                _period_get(member->handle->_driver));
+        vector_clear_interrupt_flag(member->handle);
+    }
+
+    // back-to-back start, same instruction sequence for each member
+    for (index = 0; index < _this->_member_cnt; index++) {
+        hw_register_16(CTL_register[index]) = CTL_value[index];
+    }
+
+    _this->skew = _lag_measure(&_this->_members[0], &_this->_members[_this->_member_cnt - 1]);
+
+    interrupt_restore();
+
+    _this->active = true;
+
+    return TIMER_GROUP_OK;
+}
+
+static uint8_t _stop(Timer_group_t *_this) {
+    uint8_t index;
+
+    for (index = 0; index < _this->_member_cnt; index++) {
+        timer_channel_stop(_this->_members[index].handle);
+    }
+
+    _this->active = false;
+
+    return TIMER_GROUP_OK;
+}
+
+static uint8_t _rephase(Timer_group_t *_this, uint8_t member_index, uint16_t phase) {
+    uint16_t reference_TxR_register, CTL_register, CTL_value, counter;
+    Timer_group_member_t *reference, *member;
+
+    if ( ! _this->active) {
+        return TIMER_GROUP_NOT_ACTIVE;
+    }
+
+    if ( ! member_index || member_index >= _this->_member_cnt) {
+        return TIMER_GROUP_INVALID_MEMBER;
+    }
+
+    reference = &_this->_members[0];
+    member = &_this->_members[member_index];
+
+    reference_TxR_register = reference->handle->_driver->_CTL_register + OFS_TxR;
+    CTL_register = member->handle->_driver->_CTL_register;
+
+    interrupt_suspend();
+
+    hw_register_16(CTL_register) &= ~MC;
+    CTL_value = hw_register_16(CTL_register) | member->handle->_driver->_mode;
+
+    member->phase = phase;
+
+    // align member counter to reference, the time between reference read and member start is measured as skew
+    counter = hw_register_16(reference_TxR_register);
+    hw_register_16(CTL_register + OFS_TxR) = (uint16_t) _position_reduce(
+            (int32_t) counter - reference->phase + phase, _period_get(member->handle->_driver));
+    hw_register_16(CTL_register) = CTL_value;
+
+    _this->skew = _lag_measure(reference, member);
+
+    interrupt_restore();
+
+    return TIMER_GROUP_OK;
+}
+
+// -------------------------------------------------------------------------------------
+
+// Timer_group_t destructor
+static dispose_function_t _timer_group_dispose(Timer_group_t *_this) {
+
+    _this->stop(_this);
+
+    _this->start = (uint8_t (*)(Timer_group_t *)) _unsupported_operation;
+    _this->stop = (uint8_t (*)(Timer_group_t *)) _unsupported_operation;
+    _this->rephase = (uint8_t (*)(Timer_group_t *, uint8_t, uint16_t)) _unsupported_operation;
+
+    return NULL;
+}
+
+// Timer_group_t constructor
+uint8_t timer_group_register(Timer_group_t *group, Timer_group_member_t *members, uint8_t member_cnt) {
+    uint8_t index;
+
+    zerofill(group);
+
+    if ( ! member_cnt || member_cnt > TIMER_GROUP_MEMBER_MAX) {
+        return TIMER_GROUP_INVALID_MEMBER;
+    }
+
+    // writing TxR does not set count direction, phase on down-counting slope cannot be preloaded
+    for (index = 0; index < member_cnt; index++) {
+        if ((members[index].handle->_driver->_mode & MC) == MC__UPDOWN) {
+            return TIMER_GROUP_INVALID_MEMBER;
+        }
+    }
+
+    // private
+    group->_members = members;
+    group->_member_cnt = member_cnt;
+
+    // public
+    group->start = _start;
+    group->stop = _stop;
+    group->rephase = _rephase;
+
+    __dispose_hook_register(group, _timer_group_dispose);
+
+    return TIMER_GROUP_OK;
+}
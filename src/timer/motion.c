@@ -0,0 +1,355 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2018-2019 Mutant Industries ltd.
+#include <driver/timer/motion.h>
+#include <stddef.h>
+#include <driver/interrupt.h>
+
+
+// DMA controller support check {@see DMA.h}
+#ifdef __DMA_CONTROLLER_SUPPORT__
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _unsupported_operation() {
+    return TIMER_MOTION_UNSUPPORTED_OPERATION;
+}
+
+static uint16_t _square_root(uint32_t value) {
+    uint32_t result = 0, bit = (uint32_t) 1 << 30;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+
+    while (bit) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else {
+            result >>= 1;
+        }
+
+        bit >>= 2;
+    }
+
+    return (uint16_t) result;
+}
+
+// -------------------------------------------------------------------------------------
+
+uint16_t timer_motion_ramp_compute(uint16_t *ramp, uint16_t length, Timer_motion_profile profile, uint32_t timer_frequency,
+        uint16_t start_rate, uint16_t max_rate, uint32_t acceleration) {
+
+    uint32_t start_square, range, ramp_steps, position, velocity, interval;
+    uint16_t step;
+
+    if ( ! acceleration || max_rate < start_rate) {
+        return 0;
+    }
+
+    start_square = (uint32_t) start_rate * start_rate;
+    range = (uint32_t) max_rate * max_rate - start_square;
+
+    // steps to reach max rate at given acceleration, v^2 = v0^2 + 2 * a * s
+    ramp_steps = range / (2 * acceleration) + 1;
+
+    for (step = 0; step < length && step < ramp_steps; step++) {
+        // position within ramp, 16 fractional bits
+        position = (uint32_t) (((uint64_t) step << 16) / ramp_steps);
+
+        if (profile == MOTION_S_CURVE) {
+            // smoothstep 3x^2 - 2x^3
+            position = (uint32_t) (((uint64_t) ((position * position) >> 16) * (3 * 0x10000 - 2 * position)) >> 16);
+        }
+
+        velocity = _square_root(start_square + (uint32_t) (((uint64_t) range * position) >> 16));
+        interval = velocity ? timer_frequency / velocity : UINT16_MAX;
+
+        ramp[step] = interval > UINT16_MAX ? UINT16_MAX : (uint16_t) interval;
+    }
+
+    return step;
+}
+
+// -------------------------------------------------------------------------------------
+
+static uint16_t _step_interval(Timer_motion_axis_t *axis, uint32_t step) {
+
+    // acceleration
+    if (step < axis->_ramp_steps) {
+        return axis->ramp[step];
+    }
+
+    // deceleration - ramp in reverse order
+    if (step >= axis->_step_cnt - axis->_ramp_steps) {
+        return axis->ramp[axis->_step_cnt - 1 - step];
+    }
+
+    // cruise at the end of ramp
+    return axis->ramp[axis->_ramp_steps - 1];
+}
+
+/**
+ * Compute compare values of following toggles, return count of values
+ */
+static uint16_t _chunk_fill(Timer_motion_axis_t *axis, uint16_t *chunk, uint16_t chunk_length) {
+    uint32_t toggle_cnt = axis->_step_cnt * 2;
+    uint16_t index, interval;
+
+    for (index = 0; index < chunk_length && axis->_toggle < toggle_cnt; index++, axis->_toggle++) {
+        interval = _step_interval(axis, (axis->_toggle - 1) >> 1);
+
+        // odd toggle - falling edge in the middle of step, even toggle - rising edge at start of next step
+        axis->_timestamp += (axis->_toggle & 1) ? interval / 2 : interval - interval / 2;
+        chunk[index] = axis->_timestamp;
+    }
+
+    return index;
+}
+
+/**
+ * Arm DMA transfer of given chunk, first offset values are already written to CCRn
+ */
+static void _chunk_arm(Timer_motion_axis_t *axis, uint8_t chunk_index, uint16_t offset) {
+    axis->_chunk_index = chunk_index;
+
+    if (axis->_chunk_size[chunk_index] == offset) {
+        // nothing left to transfer, axis is stopped on last toggle
+        vector_set_enabled(axis->handle, true);
+
+        return;
+    }
+
+    DMA_channel_source_address(axis->DMA_channel) = axis->buffer + chunk_index * axis->_motion->_chunk_length + offset;
+    DMA_channel_size(axis->DMA_channel) = axis->_chunk_size[chunk_index] - offset;
+    DMA_channel_set_enabled(axis->DMA_channel, true);
+}
+
+static void _axis_complete(Timer_motion_axis_t *axis) {
+    Timer_motion_t *motion = axis->_motion;
+
+    axis->_active = false;
+
+    if ( ! --motion->_active_axis_cnt) {
+        motion->active = false;
+
+        if (motion->_on_complete) {
+            motion->_on_complete(motion->_owner, NULL);
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------
+
+static void _chunk_complete_handler(Timer_motion_axis_t *axis) {
+    uint8_t released = axis->_chunk_index;
+
+    if ( ! axis->_chunk_size[released ^ 1]) {
+        // last compare value transferred, axis is stopped on last toggle
+        vector_set_enabled(axis->handle, true);
+
+        return;
+    }
+
+    if (hw_register_16(axis->handle->_CCTLn_register) & CCIFG) {
+        // compare event occurred while DMA was disabled - trigger is lost (software request does not apply
+        // to CCIFG trigger), first compare value of the chunk is written directly
+        vector_clear_interrupt_flag(axis->handle);
+        hw_register_16(axis->handle->_CCRn_register) = axis->buffer[(released ^ 1) * axis->_motion->_chunk_length];
+
+        _chunk_arm(axis, released ^ 1, 1);
+    }
+    else {
+        _chunk_arm(axis, released ^ 1, 0);
+    }
+
+    axis->_chunk_size[released] = _chunk_fill(axis, axis->buffer + released * axis->_motion->_chunk_length,
+            axis->_motion->_chunk_length);
+}
+
+static void _last_toggle_handler(Timer_motion_axis_t *axis) {
+    timer_channel_stop(axis->handle);
+    vector_set_enabled(axis->handle, false);
+
+    _axis_complete(axis);
+}
+
+// -------------------------------------------------------------------------------------
+
+static void _axis_prepare(Timer_motion_t *_this, Timer_motion_axis_t *axis, uint32_t step_cnt) {
+
+    axis->_step_cnt = step_cnt;
+    axis->_ramp_steps = (step_cnt + 1) / 2;
+
+    if (axis->_ramp_steps > axis->ramp_length) {
+        axis->_ramp_steps = axis->ramp_length;
+    }
+
+    // first toggle is the compare value set on start, compare values are relative to move start until armed
+    axis->_toggle = 1;
+    axis->_timestamp = 0;
+    axis->_chunk_size[0] = _chunk_fill(axis, axis->buffer, _this->_chunk_length);
+    axis->_chunk_size[1] = _chunk_fill(axis, axis->buffer + _this->_chunk_length, _this->_chunk_length);
+
+    // output low, toggle on each compare event, DMA is triggered by CCIFG
+    timer_channel_set_compare_mode(axis->handle, OUTMOD_0);
+    hw_register_16(axis->handle->_CCTLn_register) &= ~OUT;
+    timer_channel_set_compare_mode(axis->handle, OUTMOD_4);
+    vector_set_enabled(axis->handle, false);
+
+    // DMA channel is disabled by trigger select, source incremented, single chunk per enable
+    DMA_channel_select_trigger(axis->DMA_channel, axis->DMA_trigger);
+    DMA_channel_set_control(axis->DMA_channel, DMALEVEL__EDGE, DMASRCBYTE__WORD, DMADSTBYTE__WORD,
+            DMASRCINCR_3, DMADSTINCR_0, DMADT_0);
+    DMA_channel_destination_address(axis->DMA_channel) = (void *) axis->handle->_CCRn_register;
+
+    vector_clear_interrupt_flag(axis->DMA_channel);
+    vector_set_enabled(axis->DMA_channel, true);
+
+    axis->_active = true;
+    _this->_active_axis_cnt++;
+}
+
+static uint8_t _move(Timer_motion_t *_this, uint32_t *steps) {
+    Timer_motion_axis_t *axis;
+    uint16_t counter, start, index;
+    uint8_t axis_index;
+
+    if (_this->active) {
+        return TIMER_MOTION_ACTIVE;
+    }
+
+    for (axis_index = 0; axis_index < _this->_axis_cnt; axis_index++) {
+        if (steps[axis_index]) {
+            _axis_prepare(_this, &_this->_axes[axis_index], steps[axis_index]);
+        }
+    }
+
+    if ( ! _this->_active_axis_cnt) {
+        return TIMER_MOTION_OK;
+    }
+
+    _this->active = true;
+
+    interrupt_suspend();
+
+    timer_channel_get_counter(_this->_axes[0].handle, &counter);
+    start = counter + _this->_start_delay;
+
+    // both prepared chunks are made absolute before any axis starts
+    for (axis_index = 0, axis = _this->_axes; axis_index < _this->_axis_cnt; axis_index++, axis++) {
+        if ( ! axis->_active) {
+            continue;
+        }
+
+        for (index = 0; index < axis->_chunk_size[0] + axis->_chunk_size[1]; index++) {
+            axis->buffer[index] += start;
+        }
+
+        // following chunks are computed from absolute timestamp
+        axis->_timestamp += start;
+    }
+
+    // coordinated start - first toggle of all axes at the same tick
+    for (axis_index = 0, axis = _this->_axes; axis_index < _this->_axis_cnt; axis_index++, axis++) {
+        if ( ! axis->_active) {
+            continue;
+        }
+
+        timer_channel_set_compare_value(axis->handle, start);
+        _chunk_arm(axis, 0, 0);
+        timer_channel_start(axis->handle);
+    }
+
+    interrupt_restore();
+
+    return TIMER_MOTION_OK;
+}
+
+static uint8_t _stop(Timer_motion_t *_this) {
+    Timer_motion_axis_t *axis = _this->_axes;
+    uint8_t axis_index;
+
+    for (axis_index = 0; axis_index < _this->_axis_cnt; axis_index++, axis++) {
+        DMA_channel_set_enabled(axis->DMA_channel, false);
+        vector_set_enabled(axis->DMA_channel, false);
+
+        // output low
+        timer_channel_set_compare_mode(axis->handle, OUTMOD_0);
+        vector_set_enabled(axis->handle, false);
+
+        axis->_active = false;
+    }
+
+    _this->_active_axis_cnt = 0;
+    _this->active = false;
+
+    return TIMER_MOTION_OK;
+}
+
+// -------------------------------------------------------------------------------------
+
+// Timer_motion_t destructor
+static dispose_function_t _timer_motion_dispose(Timer_motion_t *_this) {
+
+    _this->stop(_this);
+
+    _this->_on_complete = NULL;
+
+    _this->move = (uint8_t (*)(Timer_motion_t *, uint32_t *)) _unsupported_operation;
+    _this->stop = (uint8_t (*)(Timer_motion_t *)) _unsupported_operation;
+
+    return NULL;
+}
+
+// Timer_motion_t constructor
+uint8_t timer_motion_register(Timer_motion_t *motion, Timer_motion_axis_t *axes, uint8_t axis_cnt, uint16_t chunk_length,
+        uint16_t start_delay) {
+
+    Timer_motion_axis_t *axis = axes;
+    uint8_t axis_index;
+
+    zerofill(motion);
+
+    // single-value chunk would leave no DMA transfer after missed trigger
+    if (chunk_length < 2) {
+        return TIMER_MOTION_INVALID_AXIS;
+    }
+
+    // private
+    motion->_axes = axes;
+    motion->_axis_cnt = axis_cnt;
+    motion->_chunk_length = chunk_length;
+    motion->_start_delay = start_delay;
+    motion->_owner = motion;
+
+    for (axis_index = 0; axis_index < axis_cnt; axis_index++, axis++) {
+        // coordinated start requires common counter
+        if ( ! axis->ramp_length || axis->handle->_driver != axes[0].handle->_driver) {
+            return TIMER_MOTION_INVALID_AXIS;
+        }
+
+        axis->_motion = motion;
+        axis->_active = false;
+
+        if ( ! vector_register_handler(axis->DMA_channel, _chunk_complete_handler, axis, NULL)
+                || ! vector_register_handler(axis->handle, _last_toggle_handler, axis, NULL)) {
+
+            return TIMER_MOTION_VECTOR_SLOT_UNAVAILABLE;
+        }
+
+        vector_set_enabled(axis->DMA_channel, false);
+        vector_set_enabled(axis->handle, false);
+    }
+
+    // public
+    motion->move = _move;
+    motion->stop = _stop;
+
+    __dispose_hook_register(motion, _timer_motion_dispose);
+
+    return TIMER_MOTION_OK;
+}
+
+#endif /* DMA controller support check */
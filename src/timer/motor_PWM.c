@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2018-2019 Mutant Industries ltd.
+#include <driver/timer/motor_PWM.h>
+#include <stddef.h>
+#include <driver/interrupt.h>
+
+// -------------------------------------------------------------------------------------
+
+#if ! defined(MC)
+#define MC              (0x0030)        /* Mode control */
+#endif
+#if ! defined(CLLD)
+#define CLLD            (0x0600)        /* Compare latch load source */
+#endif
+#if ! defined(CLLD_0)
+#define CLLD_0          (0x0000)        /* Compare latch load source 0 - immediate */
+#endif
+#if ! defined(CLLD_1)
+#define CLLD_1          (0x0200)        /* Compare latch load source 1 - TBR counts to 0 */
+#endif
+#if ! defined(TBCLGRP_0)
+#define TBCLGRP_0       (0x0000)        /* Timer_B compare latch load group 0 - individual */
+#endif
+#if ! defined(TBCLGRP_1)
+#define TBCLGRP_1       (0x2000)        /* Timer_B compare latch load group 1 - pairs 1&2, 3&4, 5&6 */
+#endif
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _unsupported_operation() {
+    return TIMER_MOTOR_PWM_UNSUPPORTED_OPERATION;
+}
+
+/**
+ * Switch handle to compare mode with given output mode and compare value, output low, disable compare interrupt
+ */
+static void _channel_init(Timer_channel_handle_t *handle, uint16_t output_mode, uint16_t compare_value) {
+    timer_channel_set_compare_mode(handle, output_mode);
+    hw_register_16(handle->_CCTLn_register) &= ~OUT;
+    timer_channel_set_compare_value(handle, compare_value);
+    vector_set_enabled(handle, false);
+}
+
+/**
+ * Output low (OUTMOD_0), stop handle
+ */
+static void _channel_off(Timer_channel_handle_t *handle) {
+    hw_register_16(handle->_CCTLn_register) &= ~(OUTMOD | OUT);
+    timer_channel_stop(handle);
+}
+
+/**
+ * Compare value of high side handle for given duty, clamped to [dead_time + 1, period - 1]
+ *  - high side CCRn equal to CCR0 is never toggled back by OUTMOD_6, low side CCRn equal to 0 is never toggled
+ * back by OUTMOD_2, both would overlap the other side
+ */
+static uint16_t _high_compare_value(Timer_motor_PWM_t *_this, uint16_t duty) {
+    uint16_t duty_max = _this->_period - _this->_dead_time - 1;
+
+    if ( ! duty) {
+        duty = 1;
+    }
+
+    return _this->_period - (duty > duty_max ? duty_max : duty);
+}
+
+/**
+ * Duty updates of all phases take effect together on counter zero, period in CCR0 is loaded immediately
+ */
+static uint8_t _compare_latch_enable(Timer_motor_PWM_t *_this, Timer_channel_handle_t *overflow_handle) {
+    Timer_driver_t *driver = _this->_main_handle->_driver;
+    uint8_t result;
+
+    if ((result = timer_driver_set_compare_latch(driver, CLLD_1, TBCLGRP_1, overflow_handle))) {
+        return result;
+    }
+
+    // CCR0 is not grouped in TBCLGRP_1, its own load event applies
+    if (driver->_compare_latch) {
+        hw_register_16(_this->_main_handle->_CCTLn_register) &= ~CLLD;
+    }
+
+    return TIMER_MOTOR_PWM_OK;
+}
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _start(Timer_motor_PWM_t *_this) {
+    Timer_motor_PWM_phase_t *phase;
+    uint16_t high;
+    uint8_t index;
+
+    if (_this->active) {
+        return TIMER_MOTOR_PWM_ACTIVE;
+    }
+
+    // initial compare values are loaded immediately, latches would not be loaded before the first period ends
+    timer_driver_set_compare_latch(_this->_main_handle->_driver, CLLD_0, TBCLGRP_0, NULL);
+
+    _channel_init(_this->_main_handle, OUTMOD_0, _this->_period);
+
+    for (index = 0, phase = _this->_phases; index < _this->_phase_cnt; index++, phase++) {
+        high = _high_compare_value(_this, 0);
+
+        _channel_init(phase->high_handle, OUTMOD_6, high);
+        _channel_init(phase->low_handle, OUTMOD_2, high - _this->_dead_time);
+    }
+
+    if (_this->_trigger_handle) {
+        _channel_init(_this->_trigger_handle, OUTMOD_6, _this->_trigger_point);
+    }
+
+    _compare_latch_enable(_this, NULL);
+
+    interrupt_suspend();
+
+    // counter is cleared when the first handle is started, all outputs start within one period
+    timer_channel_start(_this->_main_handle);
+
+    for (index = 0, phase = _this->_phases; index < _this->_phase_cnt; index++, phase++) {
+        timer_channel_start(phase->high_handle);
+        timer_channel_start(phase->low_handle);
+    }
+
+    if (_this->_trigger_handle) {
+        timer_channel_start(_this->_trigger_handle);
+    }
+
+    interrupt_restore();
+
+    _this->active = true;
+
+    return TIMER_MOTOR_PWM_OK;
+}
+
+static uint8_t _stop(Timer_motor_PWM_t *_this) {
+    Timer_motor_PWM_phase_t *phase;
+    uint8_t index;
+
+    interrupt_suspend();
+
+    // both switches of every half-bridge off first
+    for (index = 0, phase = _this->_phases; index < _this->_phase_cnt; index++, phase++) {
+        _channel_off(phase->high_handle);
+        _channel_off(phase->low_handle);
+    }
+
+    if (_this->_trigger_handle) {
+        _channel_off(_this->_trigger_handle);
+    }
+
+    timer_channel_stop(_this->_main_handle);
+
+    interrupt_restore();
+
+    _this->active = false;
+
+    return TIMER_MOTOR_PWM_OK;
+}
+
+static uint8_t _set_duty(Timer_motor_PWM_t *_this, uint16_t *duty) {
+    Timer_motor_PWM_phase_t *phase;
+    uint16_t high;
+    uint8_t index;
+
+    for (index = 0, phase = _this->_phases; index < _this->_phase_cnt; index++, phase++) {
+        high = _high_compare_value(_this, duty[index]);
+
+        timer_channel_set_compare_value_latched(phase->high_handle, high);
+        timer_channel_set_compare_value_latched(phase->low_handle, high - _this->_dead_time);
+    }
+
+    return timer_driver_compare_latch_commit(_this->_main_handle->_driver);
+}
+
+// -------------------------------------------------------------------------------------
+
+// Timer_motor_PWM_t destructor
+static dispose_function_t _timer_motor_PWM_dispose(Timer_motor_PWM_t *_this) {
+
+    _this->stop(_this);
+
+    _this->start = (uint8_t (*)(Timer_motor_PWM_t *)) _unsupported_operation;
+    _this->stop = (uint8_t (*)(Timer_motor_PWM_t *)) _unsupported_operation;
+    _this->set_duty = (uint8_t (*)(Timer_motor_PWM_t *, uint16_t *)) _unsupported_operation;
+
+    return NULL;
+}
+
+// Timer_motor_PWM_t constructor
+uint8_t timer_motor_PWM_register(Timer_motor_PWM_t *motor, Timer_channel_handle_t *main_handle, Timer_channel_handle_t *overflow_handle,
+        Timer_motor_PWM_config_t *config) {
+
+    uint8_t result;
+
+    zerofill(motor);
+
+    if ((main_handle->_driver->_mode & MC) != MC__UPDOWN || config->phase_cnt > TIMER_MOTOR_PWM_PHASE_MAX
+            || config->dead_time + 2 > config->period) {
+
+        return TIMER_MOTOR_PWM_INVALID_CONFIG;
+    }
+
+    // private
+    motor->_main_handle = main_handle;
+    motor->_phases = config->phases;
+    motor->_phase_cnt = config->phase_cnt;
+    motor->_trigger_handle = config->trigger_handle;
+    motor->_trigger_point = config->trigger_point;
+    motor->_period = config->period;
+    motor->_dead_time = config->dead_time;
+
+    // overflow handle is claimed for latch emulation on Timer_A
+    if ((result = _compare_latch_enable(motor, overflow_handle))) {
+        return result;
+    }
+
+    // public
+    motor->start = _start;
+    motor->stop = _stop;
+    motor->set_duty = _set_duty;
+
+    __dispose_hook_register(motor, _timer_motor_PWM_dispose);
+
+    return TIMER_MOTOR_PWM_OK;
+}
@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2018-2019 Mutant Industries ltd.
+#include <driver/timer/profile.h>
+#include <stdbool.h>
+#include <driver/interrupt.h>
+
+
+#ifdef __PROFILE_ENABLE__
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Count of calibration runs, shortest one is taken
+ */
+#define PROFILE_CALIBRATION_RUN_CNT     (8)
+
+// -------------------------------------------------------------------------------------
+
+Profile_region_t profile_region_table[__PROFILE_REGION_COUNT__];
+
+uint16_t profile_counter_register;
+
+uint16_t profile_overhead_accumulated;
+
+// cycles between counter reads of empty region
+static uint16_t _region_overhead;
+// cycles of complete empty region instrumentation seen by enclosing region
+static uint16_t _nested_region_overhead;
+
+// -------------------------------------------------------------------------------------
+
+static void _region_reset(Profile_region_t *region) {
+    region->count = 0;
+    region->min = UINT16_MAX;
+    region->max = 0;
+    region->total = 0;
+}
+
+void profile_region_end(Profile_region_t *region, uint16_t counter) {
+    uint16_t elapsed, overhead;
+
+    elapsed = counter - region->_start;
+    overhead = _region_overhead + (uint16_t) (profile_overhead_accumulated - region->_overhead_snapshot);
+
+    elapsed = elapsed > overhead ? elapsed - overhead : 0;
+
+    region->count++;
+    region->total += elapsed;
+
+    if (elapsed < region->min) {
+        region->min = elapsed;
+    }
+
+    if (elapsed > region->max) {
+        region->max = elapsed;
+    }
+
+    // cost of this region instrumentation shall not be included in enclosing region
+    profile_overhead_accumulated += _nested_region_overhead;
+}
+
+// -------------------------------------------------------------------------------------
+
+void profile_reset() {
+    uint8_t id;
+
+    for (id = 0; id < __PROFILE_REGION_COUNT__; id++) {
+        _region_reset(profile_region(id));
+    }
+}
+
+void profile_init(Timer_channel_handle_t *handle) {
+    Profile_region_t calibration, nested;
+    uint8_t run;
+
+    timer_channel_set_compare_mode(handle, OUTMOD_0);
+    vector_set_enabled(handle, false);
+    timer_channel_start(handle);
+
+    profile_counter_register = handle->_driver->_CTL_register + OFS_TxR;
+
+    interrupt_suspend();
+
+    // overhead of empty region, no correction applied yet
+    _region_overhead = _nested_region_overhead = 0;
+    _region_reset(&calibration);
+
+    for (run = 0; run < PROFILE_CALIBRATION_RUN_CNT; run++) {
+        _profile_region_begin(&calibration);
+        _profile_region_end(&calibration);
+    }
+
+    _region_overhead = calibration.min;
+
+    // overhead of empty nested region seen by enclosing one, own overhead is subtracted already
+    _region_reset(&calibration);
+    _region_reset(&nested);
+
+    for (run = 0; run < PROFILE_CALIBRATION_RUN_CNT; run++) {
+        _profile_region_begin(&calibration);
+        _profile_region_begin(&nested);
+        _profile_region_end(&nested);
+        _profile_region_end(&calibration);
+    }
+
+    _nested_region_overhead = calibration.min;
+    profile_overhead_accumulated = 0;
+
+    interrupt_restore();
+
+    profile_reset();
+}
+
+#endif /* __PROFILE_ENABLE__ */
@@ -0,0 +1,202 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2018-2019 Mutant Industries ltd.
+#include <driver/timer/pulse.h>
+#include <stddef.h>
+#include <driver/interrupt.h>
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _unsupported_operation() {
+    return TIMER_PULSE_UNSUPPORTED_OPERATION;
+}
+
+/**
+ * Set output mode applied on next compare event - leading (active level) or trailing (idle level) edge
+ */
+static inline void _edge_schedule(Timer_pulse_t *_this, bool leading) {
+    hw_register_16(_this->_handle->_CCTLn_register) = (hw_register_16(_this->_handle->_CCTLn_register) & ~OUTMOD)
+            | (leading != _this->_active_low ? OUTMOD_1 : OUTMOD_5);
+}
+
+/**
+ * Switch output to idle level (OUTMOD_0)
+ */
+static void _output_idle(Timer_pulse_t *_this) {
+    uint16_t CCTLn = hw_register_16(_this->_handle->_CCTLn_register) & ~(OUTMOD | OUT);
+
+    hw_register_16(_this->_handle->_CCTLn_register) = _this->_active_low ? CCTLn | OUT : CCTLn;
+}
+
+// -------------------------------------------------------------------------------------
+
+static void _edge_handler(Timer_pulse_t *_this) {
+
+    // leading edge output now, arm trailing edge
+    if (_this->_leading) {
+        hw_register_16(_this->_handle->_CCRn_register) += _this->_width;
+        _edge_schedule(_this, false);
+        _this->_leading = false;
+
+        return;
+    }
+
+    // trailing edge output now, arm next pulse
+    if (--_this->_pulse_remaining) {
+        hw_register_16(_this->_handle->_CCRn_register) += _this->_interval - _this->_width;
+        _edge_schedule(_this, true);
+        _this->_leading = true;
+
+        return;
+    }
+
+    _output_idle(_this);
+    timer_channel_stop(_this->_handle);
+
+    _this->active = false;
+
+    if (_this->_on_complete) {
+        _this->_on_complete(_this->_owner, _this->_event_arg);
+    }
+}
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _arm(Timer_pulse_t *_this, bool relative, uint16_t reference, uint16_t delay) {
+    Timer_channel_handle_t *handle = _this->_handle;
+    uint16_t counter;
+    uint8_t result;
+
+    if (_this->active) {
+        return TIMER_PULSE_ACTIVE;
+    }
+
+    // shape not set yet
+    if ( ! _this->_width) {
+        return TIMER_PULSE_INVALID_CONFIG;
+    }
+
+    // capture mode with no capture until started, interrupt enabled
+    timer_channel_set_compare_mode(handle, OUTMOD_0);
+    _output_idle(_this);
+
+    interrupt_suspend();
+
+    if ((result = timer_channel_start(handle))) {
+        interrupt_restore();
+
+        return result;
+    }
+
+    if (relative) {
+        timer_channel_get_counter(handle, &reference);
+    }
+
+    hw_register_16(handle->_CCRn_register) = reference + delay;
+    vector_clear_interrupt_flag(handle);
+    _edge_schedule(_this, true);
+
+    timer_channel_get_counter(handle, &counter);
+
+    // leading edge passed before armed
+    if ( ! (hw_register_16(handle->_CCTLn_register) & CCIFG) && (int16_t) (counter - (uint16_t) (reference + delay)) >= 0) {
+        _output_idle(_this);
+        timer_channel_stop(handle);
+
+        result = TIMER_PULSE_DEADLINE_MISSED;
+    }
+    else {
+        _this->_pulse_remaining = _this->_pulse_cnt;
+        _this->_leading = true;
+        _this->active = true;
+    }
+
+    interrupt_restore();
+
+    return result;
+}
+
+static uint8_t _set_shape(Timer_pulse_t *_this, uint16_t width, uint16_t interval, uint16_t pulse_cnt) {
+
+    if (_this->active) {
+        return TIMER_PULSE_ACTIVE;
+    }
+
+    // zero width would set both edges on the same compare value, trailing edge must precede next leading edge
+    if ( ! width || (pulse_cnt > 1 && interval <= width)) {
+        return TIMER_PULSE_INVALID_CONFIG;
+    }
+
+    _this->_width = width;
+    _this->_interval = interval;
+    _this->_pulse_cnt = pulse_cnt ? pulse_cnt : 1;
+
+    return TIMER_PULSE_OK;
+}
+
+static uint8_t _fire(Timer_pulse_t *_this, uint16_t delay) {
+    return _arm(_this, true, 0, delay);
+}
+
+static uint8_t _fire_at(Timer_pulse_t *_this, uint16_t reference, uint16_t delay) {
+    return _arm(_this, false, reference, delay);
+}
+
+static uint8_t _cancel(Timer_pulse_t *_this) {
+
+    interrupt_suspend();
+
+    _output_idle(_this);
+    timer_channel_stop(_this->_handle);
+
+    _this->active = false;
+
+    interrupt_restore();
+
+    return TIMER_PULSE_OK;
+}
+
+// -------------------------------------------------------------------------------------
+
+// Timer_pulse_t destructor
+static dispose_function_t _timer_pulse_dispose(Timer_pulse_t *_this) {
+
+    _this->cancel(_this);
+
+    _this->_on_complete = NULL;
+
+    _this->set_shape = (uint8_t (*)(Timer_pulse_t *, uint16_t, uint16_t, uint16_t)) _unsupported_operation;
+    _this->fire = (uint8_t (*)(Timer_pulse_t *, uint16_t)) _unsupported_operation;
+    _this->fire_at = (uint8_t (*)(Timer_pulse_t *, uint16_t, uint16_t)) _unsupported_operation;
+    _this->cancel = (uint8_t (*)(Timer_pulse_t *)) _unsupported_operation;
+
+    return NULL;
+}
+
+// Timer_pulse_t constructor
+uint8_t timer_pulse_register(Timer_pulse_t *pulse, Timer_channel_handle_t *handle, bool active_low) {
+
+    zerofill(pulse);
+
+    // private
+    pulse->_handle = handle;
+    pulse->_active_low = active_low;
+    pulse->_pulse_cnt = 1;
+    pulse->_owner = pulse;
+
+    if ( ! vector_register_handler(handle, _edge_handler, pulse, NULL)) {
+        return TIMER_PULSE_VECTOR_SLOT_UNAVAILABLE;
+    }
+
+    timer_channel_set_compare_mode(handle, OUTMOD_0);
+    _output_idle(pulse);
+
+    // public
+    pulse->set_shape = _set_shape;
+    pulse->fire = _fire;
+    pulse->fire_at = _fire_at;
+    pulse->cancel = _cancel;
+
+    __dispose_hook_register(pulse, _timer_pulse_dispose);
+
+    return TIMER_PULSE_OK;
+}
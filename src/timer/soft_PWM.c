@@ -0,0 +1,264 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2018-2019 Mutant Industries ltd.
+#include <driver/timer/soft_PWM.h>
+#include <stddef.h>
+#include <driver/interrupt.h>
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _unsupported_operation() {
+    return TIMER_SOFT_PWM_UNSUPPORTED_OPERATION;
+}
+
+/**
+ * Write driven pins of all ports
+ */
+static void _ports_write(Timer_soft_PWM_t *_this, uint16_t *value) {
+    Timer_soft_PWM_port_t *port = _this->_ports;
+    uint8_t index;
+
+    for (index = 0; index < _this->_port_cnt; index++, port++) {
+        if (port->word_access) {
+            hw_register_16(port->OUT_register) = (hw_register_16(port->OUT_register) & ~port->_pin_mask) | value[index];
+        }
+        else {
+            hw_register_8(port->OUT_register) = (uint8_t) ((hw_register_8(port->OUT_register) & ~port->_pin_mask) | value[index]);
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Build sorted edge schedule from channels duty, return count of edges
+ *  - edge 0 at period start sets all channels with non-zero duty
+ *  - every following edge resets one or more channels, edges closer than min_edge_spacing are merged
+ */
+static uint8_t _schedule_compute(Timer_soft_PWM_t *_this, Timer_soft_PWM_edge_t *schedule) {
+    Timer_soft_PWM_channel_t *channel = _this->_channels;
+    uint16_t time, time_max = _this->_period - _this->_min_edge_spacing;
+    uint8_t index, edge, position, port, edge_cnt = 1;
+
+    schedule[0].time = 0;
+
+    for (port = 0; port < _this->_port_cnt; port++) {
+        schedule[0].value[port] = 0;
+    }
+
+    // reset masks of sorted edges
+    for (index = 0; index < _this->_channel_cnt; index++, channel++) {
+        time = (uint16_t) (((uint32_t) channel->duty * _this->_period) / UINT8_MAX);
+
+        // too short pulse is merged with period start - channel off
+        if (time < _this->_min_edge_spacing) {
+            continue;
+        }
+
+        schedule[0].value[channel->port_index] |= channel->pin;
+
+        // channel on
+        if (channel->duty == UINT8_MAX) {
+            continue;
+        }
+
+        // reset must precede next period start
+        if (time > time_max) {
+            time = time_max;
+        }
+
+        for (position = 1; position < edge_cnt && schedule[position].time < time; position++);
+
+        if (position < edge_cnt && schedule[position].time - time < _this->_min_edge_spacing) {
+            schedule[position].value[channel->port_index] |= channel->pin;
+        }
+        else if (position > 1 && time - schedule[position - 1].time < _this->_min_edge_spacing) {
+            schedule[position - 1].value[channel->port_index] |= channel->pin;
+        }
+        else {
+            for (edge = edge_cnt; edge > position; edge--) {
+                schedule[edge] = schedule[edge - 1];
+            }
+
+            schedule[position].time = time;
+
+            for (port = 0; port < _this->_port_cnt; port++) {
+                schedule[position].value[port] = 0;
+            }
+
+            schedule[position].value[channel->port_index] = channel->pin;
+            edge_cnt++;
+        }
+    }
+
+    // reset masks -> port values
+    for (position = 1; position < edge_cnt; position++) {
+        for (port = 0; port < _this->_port_cnt; port++) {
+            schedule[position].value[port] = schedule[position - 1].value[port] & ~schedule[position].value[port];
+        }
+    }
+
+    return edge_cnt;
+}
+
+static void _edge_handler(Timer_soft_PWM_t *_this) {
+    uint16_t compare_value;
+
+    _ports_write(_this, _this->_schedule[_this->_active_index][_this->_edge_index].value);
+
+    if (++_this->_edge_index < _this->_edge_cnt[_this->_active_index]) {
+        compare_value = _this->_period_start + _this->_schedule[_this->_active_index][_this->_edge_index].time;
+    }
+    else {
+        // next period start
+        _this->_edge_index = 0;
+        _this->_period_start += _this->_period;
+
+        if (_this->_update_pending) {
+            _this->_update_pending = false;
+            _this->_active_index ^= 1;
+        }
+
+        compare_value = _this->_period_start;
+    }
+
+    timer_channel_set_compare_value(_this->_handle, compare_value);
+}
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _update(Timer_soft_PWM_t *_this) {
+    uint8_t inactive_index;
+
+    interrupt_suspend();
+
+    // inactive schedule is not swapped while being recomputed
+    _this->_update_pending = false;
+    inactive_index = _this->_active_index ^ 1;
+
+    interrupt_restore();
+
+    _this->_edge_cnt[inactive_index] = _schedule_compute(_this, _this->_schedule[inactive_index]);
+
+    _this->_update_pending = true;
+
+    return TIMER_SOFT_PWM_OK;
+}
+
+static uint8_t _set_duty(Timer_soft_PWM_t *_this, uint8_t channel_index, uint8_t duty) {
+
+    if (channel_index >= _this->_channel_cnt) {
+        return TIMER_SOFT_PWM_INVALID_CONFIG;
+    }
+
+    _this->_channels[channel_index].duty = duty;
+
+    return _update(_this);
+}
+
+static uint8_t _start(Timer_soft_PWM_t *_this) {
+    uint16_t counter;
+
+    if (_this->active) {
+        return TIMER_SOFT_PWM_ACTIVE;
+    }
+
+    _this->_active_index = 0;
+    _this->_edge_index = 0;
+    _this->_update_pending = false;
+    _this->_edge_cnt[0] = _schedule_compute(_this, _this->_schedule[0]);
+
+    timer_channel_set_compare_mode(_this->_handle, OUTMOD_0);
+
+    interrupt_suspend();
+
+    timer_channel_get_counter(_this->_handle, &counter);
+
+    // first period starts after min edge spacing
+    _this->_period_start = counter + _this->_min_edge_spacing;
+    timer_channel_set_compare_value(_this->_handle, _this->_period_start);
+
+    timer_channel_start(_this->_handle);
+
+    interrupt_restore();
+
+    _this->active = true;
+
+    return TIMER_SOFT_PWM_OK;
+}
+
+static uint8_t _stop(Timer_soft_PWM_t *_this) {
+    uint16_t value[TIMER_SOFT_PWM_PORT_MAX] = {0};
+
+    timer_channel_stop(_this->_handle);
+
+    _ports_write(_this, value);
+
+    _this->active = false;
+
+    return TIMER_SOFT_PWM_OK;
+}
+
+// -------------------------------------------------------------------------------------
+
+// Timer_soft_PWM_t destructor
+static dispose_function_t _timer_soft_PWM_dispose(Timer_soft_PWM_t *_this) {
+
+    _this->stop(_this);
+
+    _this->start = (uint8_t (*)(Timer_soft_PWM_t *)) _unsupported_operation;
+    _this->stop = (uint8_t (*)(Timer_soft_PWM_t *)) _unsupported_operation;
+    _this->set_duty = (uint8_t (*)(Timer_soft_PWM_t *, uint8_t, uint8_t)) _unsupported_operation;
+    _this->update = (uint8_t (*)(Timer_soft_PWM_t *)) _unsupported_operation;
+
+    return NULL;
+}
+
+// Timer_soft_PWM_t constructor
+uint8_t timer_soft_PWM_register(Timer_soft_PWM_t *pwm, Timer_channel_handle_t *handle, Timer_soft_PWM_config_t *config) {
+    Timer_soft_PWM_channel_t *channel = config->channels;
+    uint8_t index;
+
+    zerofill(pwm);
+
+    if (config->port_cnt > TIMER_SOFT_PWM_PORT_MAX) {
+        return TIMER_SOFT_PWM_INVALID_CONFIG;
+    }
+
+    for (index = 0; index < config->port_cnt; index++) {
+        config->ports[index]._pin_mask = 0;
+    }
+
+    // pins driven on each port
+    for (index = 0; index < config->channel_cnt; index++, channel++) {
+        if (channel->port_index >= config->port_cnt) {
+            return TIMER_SOFT_PWM_INVALID_CONFIG;
+        }
+
+        config->ports[channel->port_index]._pin_mask |= channel->pin;
+    }
+
+    // private
+    pwm->_handle = handle;
+    pwm->_period = config->period;
+    pwm->_min_edge_spacing = config->min_edge_spacing;
+    pwm->_ports = config->ports;
+    pwm->_port_cnt = config->port_cnt;
+    pwm->_channels = config->channels;
+    pwm->_channel_cnt = config->channel_cnt;
+    pwm->_schedule[0] = config->schedule;
+    pwm->_schedule[1] = config->schedule + config->channel_cnt + 1;
+
+    if ( ! vector_register_handler(handle, _edge_handler, pwm, NULL)) {
+        return TIMER_SOFT_PWM_VECTOR_SLOT_UNAVAILABLE;
+    }
+
+    // public
+    pwm->start = _start;
+    pwm->stop = _stop;
+    pwm->set_duty = _set_duty;
+    pwm->update = _update;
+
+    __dispose_hook_register(pwm, _timer_soft_PWM_dispose);
+
+    return TIMER_SOFT_PWM_OK;
+}
@@ -0,0 +1,338 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2018-2019 Mutant Industries ltd.
+#include <driver/timer/soft_UART.h>
+#include <stddef.h>
+#include <driver/interrupt.h>
+
+// -------------------------------------------------------------------------------------
+
+#if ! defined(SCS__SYNC)
+#define SCS__SYNC       (0x0800)        /* Capture synchronize */
+#endif
+
+/**
+ * Data bits and stop bit transmitted after start bit
+ */
+#define TIMER_SOFT_UART_FRAME_BITS      (9)
+
+/**
+ * Stop bit of transmitted frame
+ */
+#define TIMER_SOFT_UART_STOP_BIT        (0x0100)
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _unsupported_operation() {
+    return TIMER_SOFT_UART_UNSUPPORTED_OPERATION;
+}
+
+/**
+ * Set output mode applied on next compare event - set (1) or reset (0) bit
+ */
+static inline void _output_schedule(Timer_channel_handle_t *handle, bool bit) {
+    hw_register_16(handle->_CCTLn_register) = (hw_register_16(handle->_CCTLn_register) & ~OUTMOD) | (bit ? OUTMOD_1 : OUTMOD_5);
+}
+
+static inline uint16_t _index_next(uint16_t index, uint16_t length) {
+    return ++index == length ? 0 : index;
+}
+
+/**
+ * Load next character from transmit buffer to shift register, schedule start bit one bit time after current compare event
+ */
+static void _frame_load(Timer_soft_UART_t *_this) {
+
+    _this->_TX_shift = _this->_TX_buffer[_this->_TX_tail] | TIMER_SOFT_UART_STOP_BIT;
+    _this->_TX_bit_cnt = TIMER_SOFT_UART_FRAME_BITS;
+    _this->_TX_tail = _index_next(_this->_TX_tail, _this->_TX_buffer_length);
+
+    _output_schedule(_this->_TX_handle, false);
+
+    if (_this->_TX_tail == _this->_TX_head && _this->_on_transmit_buffer_empty) {
+        _this->_on_transmit_buffer_empty(_this->_owner, _this->_event_arg);
+    }
+}
+
+// -------------------------------------------------------------------------------------
+
+/**
+ * Receive - start bit edge captured, then each bit sampled in the middle of bit time
+ */
+static void _RX_handler(Timer_soft_UART_t *_this) {
+    Timer_channel_handle_t *handle = _this->_RX_handle;
+    uint16_t CCTLn = hw_register_16(handle->_CCTLn_register);
+    uint16_t head;
+
+    if (CCTLn & CAP) {
+        // switch to compare mode first, so that captured value is not overwritten
+        hw_register_16(handle->_CCTLn_register) = CCTLn & ~CAP;
+        // first sample in the middle of first data bit
+        hw_register_16(handle->_CCRn_register) += _this->_bit_time + (_this->_bit_time >> 1);
+
+        _this->_RX_bit_cnt = 0;
+
+        if (_this->_on_start_bit_received) {
+            _this->_on_start_bit_received(_this->_owner, _this->_event_arg);
+        }
+
+        return;
+    }
+
+    // input level latched on compare event, interrupt latency does not affect sampling
+    if (_this->_RX_bit_cnt < 8) {
+        _this->_RX_shift >>= 1;
+
+        if (CCTLn & SCCI) {
+            _this->_RX_shift |= 0x80;
+        }
+
+        _this->_RX_bit_cnt++;
+
+        hw_register_16(handle->_CCRn_register) += _this->_bit_time;
+
+        return;
+    }
+
+    // stop bit sampled, wait for next start bit
+    hw_register_16(handle->_CCTLn_register) = CCTLn | CAP;
+
+    if ( ! (CCTLn & SCCI)) {
+        _this->framing_error_cnt++;
+
+        return;
+    }
+
+    if ((head = _index_next(_this->_RX_head, _this->_RX_buffer_length)) == _this->_RX_tail) {
+        _this->overrun_cnt++;
+
+        return;
+    }
+
+    _this->_RX_buffer[_this->_RX_head] = _this->_RX_shift;
+    _this->_RX_head = head;
+
+    if (_this->_on_character_received) {
+        _this->_on_character_received(_this->_owner, _this->_event_arg);
+    }
+}
+
+/**
+ * Transmit - output level of each bit is set by hardware on compare event, handler schedules the following one
+ */
+static void _TX_handler(Timer_soft_UART_t *_this) {
+    Timer_channel_handle_t *handle = _this->_TX_handle;
+
+    hw_register_16(handle->_CCRn_register) += _this->_bit_time;
+
+    if (_this->_TX_bit_cnt) {
+        _output_schedule(handle, _this->_TX_shift & 1);
+
+        _this->_TX_shift >>= 1;
+        // stop bit scheduled last, TX_shift is zero afterwards
+        _this->_TX_bit_cnt--;
+
+        return;
+    }
+
+    // stop bit started
+    if ( ! _this->_TX_shift) {
+        if (_this->_TX_tail != _this->_TX_head) {
+            _frame_load(_this);
+        }
+        else {
+            // keep line idle for one bit time, then transmission is complete
+            _output_schedule(handle, true);
+            _this->_TX_shift = TIMER_SOFT_UART_STOP_BIT;
+        }
+
+        return;
+    }
+
+    // stop bit finished
+    if (_this->_TX_tail != _this->_TX_head) {
+        _frame_load(_this);
+
+        return;
+    }
+
+    vector_set_enabled(handle, false);
+    // line stays idle (OUT set) when switched to OUTMOD_0
+    hw_register_16(handle->_CCTLn_register) &= ~OUTMOD;
+
+    _this->_TX_active = false;
+
+    if (_this->_on_transmit_complete) {
+        _this->_on_transmit_complete(_this->_owner, _this->_event_arg);
+    }
+}
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _start(Timer_soft_UART_t *_this) {
+    uint8_t result;
+
+    if (_this->active) {
+        return TIMER_SOFT_UART_ACTIVE;
+    }
+
+    _this->_RX_head = _this->_RX_tail = 0;
+    _this->_TX_head = _this->_TX_tail = 0;
+    _this->_TX_active = false;
+
+    if (_this->_TX_handle) {
+        timer_channel_set_compare_mode(_this->_TX_handle, OUTMOD_0);
+        // idle line level
+        hw_register_16(_this->_TX_handle->_CCTLn_register) |= OUT;
+
+        if ((result = timer_channel_start(_this->_TX_handle))) {
+            return result;
+        }
+
+        // compare interrupt enabled only while transmitting
+        vector_set_enabled(_this->_TX_handle, false);
+    }
+
+    if (_this->_RX_handle) {
+        timer_channel_set_capture_mode(_this->_RX_handle, CM__FALLING, CCIS__CCIA, SCS__SYNC);
+
+        if ((result = timer_channel_start(_this->_RX_handle))) {
+            return result;
+        }
+    }
+
+    _this->active = true;
+
+    return TIMER_SOFT_UART_OK;
+}
+
+static uint8_t _stop(Timer_soft_UART_t *_this) {
+
+    if (_this->_RX_handle) {
+        timer_channel_stop(_this->_RX_handle);
+    }
+
+    if (_this->_TX_handle) {
+        timer_channel_stop(_this->_TX_handle);
+        vector_set_enabled(_this->_TX_handle, false);
+    }
+
+    _this->_TX_active = false;
+    _this->active = false;
+
+    return TIMER_SOFT_UART_OK;
+}
+
+static uint8_t _write(Timer_soft_UART_t *_this, uint8_t character) {
+    uint16_t head, counter;
+    uint8_t result = TIMER_SOFT_UART_OK;
+
+    if ( ! _this->active) {
+        return TIMER_SOFT_UART_NOT_ACTIVE;
+    }
+
+    interrupt_suspend();
+
+    if ((head = _index_next(_this->_TX_head, _this->_TX_buffer_length)) == _this->_TX_tail) {
+        result = TIMER_SOFT_UART_BUFFER_FULL;
+    }
+    else {
+        _this->_TX_buffer[_this->_TX_head] = character;
+        _this->_TX_head = head;
+
+        if ( ! _this->_TX_active) {
+            _this->_TX_active = true;
+
+            // start bit one bit time from now
+            timer_channel_get_counter(_this->_TX_handle, &counter);
+            hw_register_16(_this->_TX_handle->_CCRn_register) = counter + _this->_bit_time;
+
+            _frame_load(_this);
+
+            vector_clear_interrupt_flag(_this->_TX_handle);
+            vector_set_enabled(_this->_TX_handle, true);
+        }
+    }
+
+    interrupt_restore();
+
+    return result;
+}
+
+static uint8_t _read(Timer_soft_UART_t *_this, uint8_t *target) {
+
+    if (_this->_RX_tail == _this->_RX_head) {
+        return TIMER_SOFT_UART_BUFFER_EMPTY;
+    }
+
+    *target = _this->_RX_buffer[_this->_RX_tail];
+    _this->_RX_tail = _index_next(_this->_RX_tail, _this->_RX_buffer_length);
+
+    return TIMER_SOFT_UART_OK;
+}
+
+static uint16_t _available(Timer_soft_UART_t *_this) {
+    uint16_t head = _this->_RX_head;
+
+    return head >= _this->_RX_tail ? head - _this->_RX_tail : _this->_RX_buffer_length - _this->_RX_tail + head;
+}
+
+// -------------------------------------------------------------------------------------
+
+// Timer_soft_UART_t destructor
+static dispose_function_t _timer_soft_UART_dispose(Timer_soft_UART_t *_this) {
+
+    _this->stop(_this);
+
+    _this->_on_character_received = NULL;
+    _this->_on_transmit_buffer_empty = NULL;
+    _this->_on_start_bit_received = NULL;
+    _this->_on_transmit_complete = NULL;
+
+    _this->start = (uint8_t (*)(Timer_soft_UART_t *)) _unsupported_operation;
+    _this->stop = (uint8_t (*)(Timer_soft_UART_t *)) _unsupported_operation;
+    _this->write = (uint8_t (*)(Timer_soft_UART_t *, uint8_t)) _unsupported_operation;
+
+    // characters already received can still be read after disposed
+
+    return NULL;
+}
+
+// Timer_soft_UART_t constructor
+uint8_t timer_soft_UART_register(Timer_soft_UART_t *uart, Timer_channel_handle_t *RX_handle, Timer_channel_handle_t *TX_handle,
+        Timer_soft_UART_config_t *config) {
+
+    zerofill(uart);
+
+    // private
+    uart->_RX_handle = RX_handle;
+    uart->_TX_handle = TX_handle;
+    uart->_bit_time = (uint16_t) ((config->timer_frequency + (config->baudrate >> 1)) / config->baudrate);
+    uart->_RX_buffer = config->RX_buffer;
+    uart->_RX_buffer_length = config->RX_buffer_length;
+    uart->_TX_buffer = config->TX_buffer;
+    uart->_TX_buffer_length = config->TX_buffer_length;
+    uart->_owner = uart;
+
+    if (RX_handle && ! vector_register_handler(RX_handle, _RX_handler, uart, NULL)) {
+        return TIMER_SOFT_UART_VECTOR_SLOT_UNAVAILABLE;
+    }
+
+    if (TX_handle && ! vector_register_handler(TX_handle, _TX_handler, uart, NULL)) {
+        if (RX_handle) {
+            vector_release_handler(RX_handle);
+        }
+
+        return TIMER_SOFT_UART_VECTOR_SLOT_UNAVAILABLE;
+    }
+
+    // public
+    uart->start = _start;
+    uart->stop = _stop;
+    uart->write = TX_handle ? _write : (uint8_t (*)(Timer_soft_UART_t *, uint8_t)) _unsupported_operation;
+    uart->read = _read;
+    uart->available = _available;
+
+    __dispose_hook_register(uart, _timer_soft_UART_dispose);
+
+    return TIMER_SOFT_UART_OK;
+}
@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2018-2019 Mutant Industries ltd.
+#include <driver/timer/waveform.h>
+#include <stddef.h>
+#include <driver/interrupt.h>
+
+
+// DMA controller support check {@see DMA.h}
+#ifdef __DMA_CONTROLLER_SUPPORT__
+
+// -------------------------------------------------------------------------------------
+
+#if ! defined(OUTMOD)
+#define OUTMOD          (0x00e0)        /* Output mode */
+#endif
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _unsupported_operation() {
+    return TIMER_WAVEFORM_UNSUPPORTED_OPERATION;
+}
+
+/**
+ * Switch handle to compare mode with given output mode, disable compare interrupt (DMA is triggered by CCIFG) and start
+ */
+static void _channel_start(Timer_channel_handle_t *handle, uint16_t output_mode) {
+    timer_channel_set_compare_mode(handle, output_mode);
+    vector_set_enabled(handle, false);
+    timer_channel_start(handle);
+}
+
+// -------------------------------------------------------------------------------------
+
+static void _transfer_complete_handler(Timer_waveform_t *_this) {
+    uint16_t *buffer_released = NULL;
+
+    if (_this->_mode == WAVEFORM_ONE_SHOT) {
+        // DMAEN is reset by HW once single transfer is completed, trigger and output handles keep running
+        vector_set_enabled(_this->_DMA_channel, false);
+        _this->active = false;
+
+        buffer_released = _this->_buffer;
+    }
+    else if (_this->_buffer_next) {
+        // next buffer has just been loaded to DMA channel on block repeat
+        buffer_released = _this->_buffer;
+        _this->_buffer = _this->_buffer_next;
+        _this->_buffer_next = NULL;
+    }
+
+    // otherwise nothing was set in time, current buffer is being transferred again
+
+    if (buffer_released && _this->_on_buffer_released) {
+        _this->_on_buffer_released(_this->_owner, buffer_released);
+    }
+
+    // DMA source address is written here only, so that the buffer loaded on block repeat is always known
+    if (_this->_mode == WAVEFORM_DOUBLE_BUFFERED && _this->_buffer_queued) {
+        _this->_buffer_next = _this->_buffer_queued;
+        _this->_buffer_queued = NULL;
+
+        // DMA temporary source address register is reloaded from DMAxSA on next block repeat
+        DMA_channel_source_address(_this->_DMA_channel) = _this->_buffer_next;
+    }
+}
+
+// -------------------------------------------------------------------------------------
+
+static uint8_t _start(Timer_waveform_t *_this, Timer_waveform_mode mode, uint16_t *buffer, uint16_t length) {
+
+    if (_this->active) {
+        return TIMER_WAVEFORM_ACTIVE;
+    }
+
+    if (mode != WAVEFORM_ONE_SHOT && mode != WAVEFORM_LOOP && mode != WAVEFORM_DOUBLE_BUFFERED) {
+        return TIMER_WAVEFORM_INVALID_MODE;
+    }
+
+    _this->_mode = mode;
+    _this->_buffer = buffer;
+    _this->_buffer_next = NULL;
+    _this->_buffer_queued = NULL;
+
+    // DMA channel is disabled by trigger select, source incremented, CCRn destination, repeated unless one-shot
+    DMA_channel_select_trigger(_this->_DMA_channel, _this->_DMA_trigger);
+    DMA_channel_set_control(_this->_DMA_channel, DMALEVEL__EDGE, DMASRCBYTE__WORD, DMADSTBYTE__WORD,
+            DMASRCINCR_3, DMADSTINCR_0, mode == WAVEFORM_ONE_SHOT ? DMADT_0 : DMADT_4);
+
+    DMA_channel_source_address(_this->_DMA_channel) = buffer;
+    DMA_channel_destination_address(_this->_DMA_channel) = (void *) _this->_output_handle->_CCRn_register;
+    DMA_channel_size(_this->_DMA_channel) = length;
+
+    // transfer complete interrupt is not needed in loop mode
+    vector_clear_interrupt_flag(_this->_DMA_channel);
+    vector_set_enabled(_this->_DMA_channel, mode != WAVEFORM_LOOP);
+
+    DMA_channel_set_enabled(_this->_DMA_channel, true);
+
+    _this->active = true;
+
+    // trigger handle keeps its output mode
+    if (_this->_trigger_handle != _this->_output_handle) {
+        _channel_start(_this->_trigger_handle, hw_register_16(_this->_trigger_handle->_CCTLn_register) & OUTMOD);
+    }
+
+    _channel_start(_this->_output_handle, _this->_output_mode);
+
+    return TIMER_WAVEFORM_OK;
+}
+
+static uint8_t _stop(Timer_waveform_t *_this) {
+
+    DMA_channel_set_enabled(_this->_DMA_channel, false);
+    vector_set_enabled(_this->_DMA_channel, false);
+
+    timer_channel_stop(_this->_output_handle);
+
+    if (_this->_trigger_handle != _this->_output_handle) {
+        timer_channel_stop(_this->_trigger_handle);
+    }
+
+    _this->_buffer = NULL;
+    _this->_buffer_next = NULL;
+    _this->_buffer_queued = NULL;
+    _this->active = false;
+
+    return TIMER_WAVEFORM_OK;
+}
+
+static uint8_t _queue(Timer_waveform_t *_this, uint16_t *buffer) {
+
+    if (_this->_mode != WAVEFORM_DOUBLE_BUFFERED) {
+        return TIMER_WAVEFORM_UNSUPPORTED_OPERATION;
+    }
+
+    if ( ! _this->active) {
+        return TIMER_WAVEFORM_NOT_ACTIVE;
+    }
+
+    // taken over by transfer complete interrupt
+    _this->_buffer_queued = buffer;
+
+    return TIMER_WAVEFORM_OK;
+}
+
+// -------------------------------------------------------------------------------------
+
+// Timer_waveform_t destructor
+static dispose_function_t _timer_waveform_dispose(Timer_waveform_t *_this) {
+
+    _this->stop(_this);
+
+    vector_release_handler(_this->_DMA_channel);
+
+    _this->_on_buffer_released = NULL;
+
+    _this->start = (uint8_t (*)(Timer_waveform_t *, Timer_waveform_mode, uint16_t *, uint16_t)) _unsupported_operation;
+    _this->stop = (uint8_t (*)(Timer_waveform_t *)) _unsupported_operation;
+    _this->queue = (uint8_t (*)(Timer_waveform_t *, uint16_t *)) _unsupported_operation;
+
+    return NULL;
+}
+
+// Timer_waveform_t constructor
+uint8_t timer_waveform_register(Timer_waveform_t *waveform, Timer_channel_handle_t *trigger_handle, Timer_channel_handle_t *output_handle,
+        DMA_channel_handle_t *DMA_channel, uint16_t DMA_trigger, uint16_t output_mode) {
+
+    zerofill(waveform);
+
+    // private
+    waveform->_trigger_handle = trigger_handle;
+    waveform->_output_handle = output_handle;
+    waveform->_DMA_channel = DMA_channel;
+    waveform->_DMA_trigger = DMA_trigger;
+    waveform->_output_mode = output_mode;
+    waveform->_owner = waveform;
+
+    if ( ! vector_register_handler(DMA_channel, _transfer_complete_handler, waveform, NULL)) {
+        return TIMER_WAVEFORM_VECTOR_SLOT_UNAVAILABLE;
+    }
+
+    // transfer complete interrupt is enabled on start() when needed
+    vector_set_enabled(DMA_channel, false);
+
+    // public
+    waveform->start = _start;
+    waveform->stop = _stop;
+    waveform->queue = _queue;
+
+    __dispose_hook_register(waveform, _timer_waveform_dispose);
+
+    return TIMER_WAVEFORM_OK;
+}
+
+#endif /* DMA controller support check */
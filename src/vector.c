@@ -209,6 +209,20 @@ static uint8_t _disable_slot_release_on_dispose(Vector_handle_t *_this) {
 
 // -------------------------------------------------------------------------------------
 
+void __vector_release_handler(Vector_handle_t *handle) {
+
+    handle->set_enabled(handle, false);
+
+    // shared vector handle - handler of handle is cleared, own slot - handler of slot is cleared
+    handle->register_handler(handle, NULL, NULL, NULL);
+
+    dispose(handle->_slot);
+
+    handle->_slot = NULL;
+}
+
+// -------------------------------------------------------------------------------------
+
 // Vector_handle_t destructor
 static dispose_function_t _vector_handle_dispose(Vector_handle_t *_this) {
 
@@ -5,15 +5,8 @@
 #include <driver/interrupt.h>
 
 
-/**
- * DMA controller support check, required:
- *  - DMA_BASE - address od DMACTL0
- *  - OFS_DMAIV - offset of IV register from base (DMAIV - DMA_BASE)
- *  - DMA_VECTOR - number of DMA interrupt vector
- *  - OFS_DMACTL4 - offset of DMA config register (x2xx and x4xx are not supported)
- *  - OFS_DMAxSA, OFS_DMAxDA, OFS_DMAxSZ - offsets of DMA source / destination address and size registers from DMAxCTL
- */
-#if defined(DMA_BASE) && defined(OFS_DMAIV) && defined(DMA_VECTOR) && defined(OFS_DMACTL4)
+// DMA controller support check {@see DMA.h}
+#ifdef __DMA_CONTROLLER_SUPPORT__
 
 // -------------------------------------------------------------------------------------
 